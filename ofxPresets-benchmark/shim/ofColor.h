@@ -0,0 +1,181 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofColor_ template.
+// Channel ranges and HSB conversions follow the openFrameworks implementation.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+template<typename PixelType>
+class ofColor_ {
+public:
+    PixelType r = 0, g = 0, b = 0, a = limit();
+
+    ofColor_() = default;
+    ofColor_(float gray, float alpha = limit()) : r(static_cast<PixelType>(gray)), g(static_cast<PixelType>(gray)), b(static_cast<PixelType>(gray)), a(static_cast<PixelType>(alpha)) {}
+    ofColor_(float r, float g, float b, float alpha = limit())
+        : r(static_cast<PixelType>(r)), g(static_cast<PixelType>(g)), b(static_cast<PixelType>(b)), a(static_cast<PixelType>(alpha)) {}
+
+    template<typename Other>
+    ofColor_(const ofColor_<Other>& c) {
+        const float scale = limit() / static_cast<float>(ofColor_<Other>::limit());
+        r = static_cast<PixelType>(c.r * scale);
+        g = static_cast<PixelType>(c.g * scale);
+        b = static_cast<PixelType>(c.b * scale);
+        a = static_cast<PixelType>(c.a * scale);
+    }
+
+    static constexpr float limit() {
+        return std::is_floating_point<PixelType>::value ? 1.0f : static_cast<float>(std::numeric_limits<PixelType>::max());
+    }
+
+    static ofColor_ fromHex(int hexColor, float alpha = limit()) {
+        ofColor_ c;
+        c.setHex(hexColor, alpha);
+        return c;
+    }
+
+    void setHex(int hexColor, float alpha = limit()) {
+        const float scale = limit() / 255.0f;
+        r = static_cast<PixelType>(((hexColor >> 16) & 0xff) * scale);
+        g = static_cast<PixelType>(((hexColor >> 8) & 0xff) * scale);
+        b = static_cast<PixelType>((hexColor & 0xff) * scale);
+        a = static_cast<PixelType>(alpha);
+    }
+
+    int getHex() const {
+        const float scale = 255.0f / limit();
+        return (static_cast<int>(r * scale) << 16) | (static_cast<int>(g * scale) << 8) | static_cast<int>(b * scale);
+    }
+
+    ofColor_& lerp(const ofColor_& target, float amount) {
+        const float inv = 1.0f - amount;
+        r = static_cast<PixelType>(inv * r + amount * target.r);
+        g = static_cast<PixelType>(inv * g + amount * target.g);
+        b = static_cast<PixelType>(inv * b + amount * target.b);
+        a = static_cast<PixelType>(inv * a + amount * target.a);
+        return *this;
+    }
+
+    ofColor_ getLerped(const ofColor_& target, float amount) const {
+        ofColor_ c = *this;
+        return c.lerp(target, amount);
+    }
+
+    float getBrightness() const { return static_cast<float>(std::max({ r, g, b })); }
+
+    float getHue() const {
+        float h, s, v;
+        getHsb(h, s, v);
+        return h;
+    }
+
+    float getSaturation() const {
+        float h, s, v;
+        getHsb(h, s, v);
+        return s;
+    }
+
+    void getHsb(float& hue, float& saturation, float& brightness) const {
+        float max = getBrightness();
+        if (max == 0) {
+            hue = 0; saturation = 0; brightness = 0;
+            return;
+        }
+        float min = static_cast<float>(std::min({ r, g, b }));
+        if (max == min) {
+            hue = 0; saturation = 0; brightness = max;
+            return;
+        }
+        float hueSixth;
+        if (r == max) {
+            hueSixth = (g - b) / (max - min);
+            if (hueSixth < 0) hueSixth += 6;
+        }
+        else if (g == max) {
+            hueSixth = 2.f + (b - r) / (max - min);
+        }
+        else {
+            hueSixth = 4.f + (r - g) / (max - min);
+        }
+        hue = limit() * hueSixth / 6.f;
+        saturation = limit() * (max - min) / max;
+        brightness = max;
+    }
+
+    void setHsb(float hue, float saturation, float brightness, float alpha) {
+        saturation = std::clamp(saturation, 0.0f, limit());
+        brightness = std::clamp(brightness, 0.0f, limit());
+        hue = std::fmod(hue, limit());
+        if (hue < 0) hue += limit();
+        if (brightness == 0) {
+            r = g = b = 0;
+        }
+        else if (saturation == 0) {
+            r = g = b = static_cast<PixelType>(brightness);
+        }
+        else {
+            float hueSix = hue * 6.f / limit();
+            float saturationNorm = saturation / limit();
+            int hueSixCategory = static_cast<int>(std::floor(hueSix));
+            float hueSixRemainder = hueSix - hueSixCategory;
+            PixelType pv = static_cast<PixelType>((1.f - saturationNorm) * brightness);
+            PixelType qv = static_cast<PixelType>((1.f - saturationNorm * hueSixRemainder) * brightness);
+            PixelType tv = static_cast<PixelType>((1.f - saturationNorm * (1.f - hueSixRemainder)) * brightness);
+            PixelType bv = static_cast<PixelType>(brightness);
+            switch (hueSixCategory) {
+            case 0: case 6: r = bv; g = tv; b = pv; break;
+            case 1: r = qv; g = bv; b = pv; break;
+            case 2: r = pv; g = bv; b = tv; break;
+            case 3: r = pv; g = qv; b = bv; break;
+            case 4: r = tv; g = pv; b = bv; break;
+            case 5: r = bv; g = pv; b = qv; break;
+            }
+        }
+        a = static_cast<PixelType>(alpha);
+    }
+
+    void setHue(float hue) {
+        float h, s, v;
+        getHsb(h, s, v);
+        setHsb(hue, s, v, a);
+    }
+
+    void setSaturation(float saturation) {
+        float h, s, v;
+        getHsb(h, s, v);
+        setHsb(h, saturation, v, a);
+    }
+
+    void setBrightness(float brightness) {
+        float h, s, v;
+        getHsb(h, s, v);
+        setHsb(h, s, brightness, a);
+    }
+
+    PixelType& operator[](size_t n) { return n == 0 ? r : n == 1 ? g : n == 2 ? b : a; }
+    const PixelType& operator[](size_t n) const { return n == 0 ? r : n == 1 ? g : n == 2 ? b : a; }
+
+    bool operator==(const ofColor_& c) const { return r == c.r && g == c.g && b == c.b && a == c.a; }
+    bool operator!=(const ofColor_& c) const { return !(*this == c); }
+
+    friend std::ostream& operator<<(std::ostream& out, const ofColor_& c) {
+        return out << +c.r << ", " << +c.g << ", " << +c.b << ", " << +c.a;
+    }
+
+    static const ofColor_ white, black, gray, red, green, blue;
+};
+
+template<typename P> const ofColor_<P> ofColor_<P>::white(limit(), limit(), limit());
+template<typename P> const ofColor_<P> ofColor_<P>::black(0, 0, 0);
+template<typename P> const ofColor_<P> ofColor_<P>::gray(limit() / 2, limit() / 2, limit() / 2);
+template<typename P> const ofColor_<P> ofColor_<P>::red(limit(), 0, 0);
+template<typename P> const ofColor_<P> ofColor_<P>::green(0, limit(), 0);
+template<typename P> const ofColor_<P> ofColor_<P>::blue(0, 0, limit());
+
+typedef ofColor_<unsigned char> ofColor;
+typedef ofColor_<unsigned short> ofShortColor;
+typedef ofColor_<float> ofFloatColor;
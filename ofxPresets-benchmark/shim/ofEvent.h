@@ -0,0 +1,63 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofEvent.
+// Listeners are plain std::functions and live as long as the event does.
+
+#include <functional>
+#include <vector>
+
+class ofEventListener {
+};
+
+template<typename T>
+class ofEvent {
+public:
+    void add(std::function<void(T&)> listener) { listeners.push_back(std::move(listener)); }
+    ofEventListener newListener(std::function<void(T&)> listener) { add(std::move(listener)); return {}; }
+
+    void notify(T& args) {
+        for (auto& listener : listeners) listener(args);
+    }
+    void notify(const void*, T& args) { notify(args); }
+
+    size_t size() const { return listeners.size(); }
+
+private:
+    std::vector<std::function<void(T&)>> listeners;
+};
+
+template<>
+class ofEvent<void> {
+public:
+    void add(std::function<void()> listener) { listeners.push_back(std::move(listener)); }
+    ofEventListener newListener(std::function<void()> listener) { add(std::move(listener)); return {}; }
+
+    void notify() {
+        for (auto& listener : listeners) listener();
+    }
+    void notify(const void*) { notify(); }
+
+    size_t size() const { return listeners.size(); }
+
+private:
+    std::vector<std::function<void()>> listeners;
+};
+
+inline void ofNotifyEvent(ofEvent<void>& event, const void* sender = nullptr) {
+    event.notify(sender);
+}
+
+template<typename T>
+void ofNotifyEvent(ofEvent<T>& event, T& args, const void* sender = nullptr) {
+    event.notify(sender, args);
+}
+
+template<typename Listener>
+void ofAddListener(ofEvent<void>& event, Listener* listener, void (Listener::*method)()) {
+    event.add([listener, method]() { (listener->*method)(); });
+}
+
+template<typename T, typename Listener>
+void ofAddListener(ofEvent<T>& event, Listener* listener, void (Listener::*method)(T&)) {
+    event.add([listener, method](T& args) { (listener->*method)(args); });
+}
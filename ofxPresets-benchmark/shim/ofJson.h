@@ -0,0 +1,293 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofJson (nlohmann::json).
+// Covers only the subset of the API used by ofxPresets.
+
+#include <cstdint>
+#include <cmath>
+#include <istream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class ofJson {
+public:
+    enum class Type { Null, Bool, Int, Float, String, Array, Object };
+    using object_t = std::map<std::string, ofJson>;
+    using array_t = std::vector<ofJson>;
+
+    ofJson() = default;
+    ofJson(std::nullptr_t) {}
+    ofJson(bool v) : type(Type::Bool), b(v) {}
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    ofJson(T v) : type(Type::Int), i(static_cast<int64_t>(v)) {}
+    template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    ofJson(T v) : type(Type::Float), d(static_cast<double>(v)) {}
+    ofJson(const char* v) : type(Type::String), s(v) {}
+    ofJson(const std::string& v) : type(Type::String), s(v) {}
+
+    static ofJson array() { ofJson j; j.type = Type::Array; return j; }
+    static ofJson object() { ofJson j; j.type = Type::Object; return j; }
+
+    bool is_null() const { return type == Type::Null; }
+    bool is_boolean() const { return type == Type::Bool; }
+    bool is_number() const { return type == Type::Int || type == Type::Float; }
+    bool is_number_integer() const { return type == Type::Int; }
+    bool is_string() const { return type == Type::String; }
+    bool is_array() const { return type == Type::Array; }
+    bool is_object() const { return type == Type::Object; }
+
+    size_t size() const {
+        if (type == Type::Array) return arr.size();
+        if (type == Type::Object) return obj.size();
+        return type == Type::Null ? 0 : 1;
+    }
+
+    ofJson& operator[](const std::string& key) {
+        if (type == Type::Null) type = Type::Object;
+        if (type != Type::Object) throw std::domain_error("ofJson: not an object");
+        return obj[key];
+    }
+    ofJson& operator[](const char* key) { return (*this)[std::string(key)]; }
+    const ofJson& operator[](const std::string& key) const { return at(key); }
+    ofJson& operator[](size_t idx) {
+        if (type == Type::Null) type = Type::Array;
+        if (type != Type::Array) throw std::domain_error("ofJson: not an array");
+        if (idx >= arr.size()) arr.resize(idx + 1);
+        return arr[idx];
+    }
+    const ofJson& operator[](size_t idx) const { return arr.at(idx); }
+    ofJson& operator[](int idx) { return (*this)[static_cast<size_t>(idx)]; }
+    const ofJson& operator[](int idx) const { return arr.at(static_cast<size_t>(idx)); }
+
+    const ofJson& at(const std::string& key) const {
+        if (type != Type::Object) throw std::domain_error("ofJson: not an object");
+        auto it = obj.find(key);
+        if (it == obj.end()) throw std::out_of_range("ofJson: key not found " + key);
+        return it->second;
+    }
+
+    bool contains(const std::string& key) const {
+        return type == Type::Object && obj.find(key) != obj.end();
+    }
+
+    void push_back(const ofJson& v) {
+        if (type == Type::Null) type = Type::Array;
+        if (type != Type::Array) throw std::domain_error("ofJson: not an array");
+        arr.push_back(v);
+    }
+
+    // items() of an object; structured bindings bind to the map pair
+    object_t& items() {
+        if (type == Type::Null) type = Type::Object;
+        return obj;
+    }
+    const object_t& items() const { return obj; }
+
+    array_t::iterator begin() { return arr.begin(); }
+    array_t::iterator end() { return arr.end(); }
+    array_t::const_iterator begin() const { return arr.begin(); }
+    array_t::const_iterator end() const { return arr.end(); }
+
+    template<typename T>
+    T get() const {
+        if constexpr (std::is_same<T, bool>::value) {
+            if (type == Type::Bool) return b;
+            if (type == Type::Int) return i != 0;
+            throw std::domain_error("ofJson: type must be boolean");
+        }
+        else if constexpr (std::is_arithmetic<T>::value) {
+            if (type == Type::Int) return static_cast<T>(i);
+            if (type == Type::Float) return static_cast<T>(d);
+            if (type == Type::Bool) return static_cast<T>(b);
+            throw std::domain_error("ofJson: type must be number");
+        }
+        else if constexpr (std::is_same<T, std::string>::value) {
+            if (type == Type::String) return s;
+            throw std::domain_error("ofJson: type must be string");
+        }
+        else {
+            static_assert(sizeof(T) == 0, "ofJson shim: unsupported get<T>");
+        }
+    }
+
+    std::string dump(int indent = -1) const {
+        std::ostringstream out;
+        write(out, indent, 0);
+        return out.str();
+    }
+
+    static ofJson parse(const std::string& text) {
+        size_t pos = 0;
+        ofJson j = parseValue(text, pos);
+        skipSpace(text, pos);
+        if (pos != text.size()) throw std::invalid_argument("ofJson: trailing characters");
+        return j;
+    }
+
+    friend std::istream& operator>>(std::istream& in, ofJson& j) {
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        j = parse(text);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const ofJson& j) {
+        return out << j.dump();
+    }
+
+private:
+    Type type = Type::Null;
+    bool b = false;
+    int64_t i = 0;
+    double d = 0.0;
+    std::string s;
+    array_t arr;
+    object_t obj;
+
+    static void writeString(std::ostream& out, const std::string& str) {
+        out << '"';
+        for (char c : str) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c;
+            }
+        }
+        out << '"';
+    }
+
+    void write(std::ostream& out, int indent, int depth) const {
+        auto newline = [&](int d) {
+            if (indent >= 0) {
+                out << '\n' << std::string(static_cast<size_t>(indent * d), ' ');
+            }
+        };
+        switch (type) {
+        case Type::Null: out << "null"; break;
+        case Type::Bool: out << (b ? "true" : "false"); break;
+        case Type::Int: out << i; break;
+        case Type::Float: {
+            std::ostringstream tmp;
+            tmp.precision(17); // round trip, like nlohmann::json
+            tmp << d;
+            std::string str = tmp.str();
+            if (str.find_first_of(".eE") == std::string::npos && std::isfinite(d)) str += ".0";
+            out << str;
+            break;
+        }
+        case Type::String: writeString(out, s); break;
+        case Type::Array: {
+            out << '[';
+            for (size_t k = 0; k < arr.size(); ++k) {
+                if (k) out << ',';
+                newline(depth + 1);
+                arr[k].write(out, indent, depth + 1);
+            }
+            if (!arr.empty()) newline(depth);
+            out << ']';
+            break;
+        }
+        case Type::Object: {
+            out << '{';
+            bool first = true;
+            for (auto& [key, value] : obj) {
+                if (!first) out << ',';
+                first = false;
+                newline(depth + 1);
+                writeString(out, key);
+                out << (indent >= 0 ? ": " : ":");
+                value.write(out, indent, depth + 1);
+            }
+            if (!obj.empty()) newline(depth);
+            out << '}';
+            break;
+        }
+        }
+    }
+
+    static void skipSpace(const std::string& t, size_t& p) {
+        while (p < t.size() && (t[p] == ' ' || t[p] == '\n' || t[p] == '\r' || t[p] == '\t')) ++p;
+    }
+
+    static ofJson parseValue(const std::string& t, size_t& p) {
+        skipSpace(t, p);
+        if (p >= t.size()) throw std::invalid_argument("ofJson: unexpected end of input");
+        char c = t[p];
+        if (c == '{') {
+            ofJson j = object();
+            ++p;
+            skipSpace(t, p);
+            if (p < t.size() && t[p] == '}') { ++p; return j; }
+            while (true) {
+                skipSpace(t, p);
+                std::string key = parseString(t, p);
+                skipSpace(t, p);
+                if (p >= t.size() || t[p] != ':') throw std::invalid_argument("ofJson: expected ':'");
+                ++p;
+                j.obj[key] = parseValue(t, p);
+                skipSpace(t, p);
+                if (p < t.size() && t[p] == ',') { ++p; continue; }
+                if (p < t.size() && t[p] == '}') { ++p; return j; }
+                throw std::invalid_argument("ofJson: expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            ofJson j = array();
+            ++p;
+            skipSpace(t, p);
+            if (p < t.size() && t[p] == ']') { ++p; return j; }
+            while (true) {
+                j.arr.push_back(parseValue(t, p));
+                skipSpace(t, p);
+                if (p < t.size() && t[p] == ',') { ++p; continue; }
+                if (p < t.size() && t[p] == ']') { ++p; return j; }
+                throw std::invalid_argument("ofJson: expected ',' or ']'");
+            }
+        }
+        if (c == '"') return ofJson(parseString(t, p));
+        if (t.compare(p, 4, "true") == 0) { p += 4; return ofJson(true); }
+        if (t.compare(p, 5, "false") == 0) { p += 5; return ofJson(false); }
+        if (t.compare(p, 4, "null") == 0) { p += 4; return ofJson(); }
+
+        size_t start = p;
+        bool isFloat = false;
+        if (t[p] == '-' || t[p] == '+') ++p;
+        while (p < t.size() && (std::isdigit(static_cast<unsigned char>(t[p])) || t[p] == '.' || t[p] == 'e' || t[p] == 'E' || t[p] == '-' || t[p] == '+')) {
+            if (t[p] == '.' || t[p] == 'e' || t[p] == 'E') isFloat = true;
+            ++p;
+        }
+        if (start == p) throw std::invalid_argument("ofJson: unexpected character");
+        std::string num = t.substr(start, p - start);
+        if (isFloat) return ofJson(std::stod(num));
+        return ofJson(static_cast<int64_t>(std::stoll(num)));
+    }
+
+    static std::string parseString(const std::string& t, size_t& p) {
+        if (p >= t.size() || t[p] != '"') throw std::invalid_argument("ofJson: expected string");
+        ++p;
+        std::string out;
+        while (p < t.size() && t[p] != '"') {
+            if (t[p] == '\\' && p + 1 < t.size()) {
+                ++p;
+                switch (t[p]) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                default: out += t[p];
+                }
+            }
+            else {
+                out += t[p];
+            }
+            ++p;
+        }
+        if (p >= t.size()) throw std::invalid_argument("ofJson: unterminated string");
+        ++p;
+        return out;
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofLog.
+// Messages below the current level are discarded; everything else goes to stderr.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+enum ofLogLevel {
+    OF_LOG_VERBOSE,
+    OF_LOG_NOTICE,
+    OF_LOG_WARNING,
+    OF_LOG_ERROR,
+    OF_LOG_FATAL_ERROR,
+    OF_LOG_SILENT
+};
+
+inline ofLogLevel& ofShimLogLevel() {
+    static ofLogLevel level = OF_LOG_NOTICE;
+    return level;
+}
+
+inline void ofSetLogLevel(ofLogLevel level) { ofShimLogLevel() = level; }
+inline ofLogLevel ofGetLogLevel() { return ofShimLogLevel(); }
+
+class ofLog {
+public:
+    ofLog() : level(OF_LOG_NOTICE) {}
+    ofLog(ofLogLevel level) : level(level) {}
+    ofLog(ofLogLevel level, const std::string& module) : level(level), module(module) {}
+
+    ~ofLog() {
+        if (level >= ofShimLogLevel() && ofShimLogLevel() != OF_LOG_SILENT) {
+            std::cerr << (module.empty() ? "" : "[" + module + "] ") << message.str() << std::endl;
+        }
+    }
+
+    template<typename T>
+    ofLog& operator<<(const T& value) {
+        if (level >= ofShimLogLevel()) {
+            message << value;
+        }
+        return *this;
+    }
+
+    ofLog(const ofLog&) = delete;
+    ofLog& operator=(const ofLog&) = delete;
+
+protected:
+    ofLogLevel level;
+    std::string module;
+    std::ostringstream message;
+};
+
+class ofLogVerbose : public ofLog {
+public:
+    ofLogVerbose(const std::string& module = "") : ofLog(OF_LOG_VERBOSE, module) {}
+};
+
+class ofLogNotice : public ofLog {
+public:
+    ofLogNotice(const std::string& module = "") : ofLog(OF_LOG_NOTICE, module) {}
+};
+
+class ofLogWarning : public ofLog {
+public:
+    ofLogWarning(const std::string& module = "") : ofLog(OF_LOG_WARNING, module) {}
+};
+
+class ofLogError : public ofLog {
+public:
+    ofLogError(const std::string& module = "") : ofLog(OF_LOG_ERROR, module) {}
+};
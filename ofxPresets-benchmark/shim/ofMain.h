@@ -0,0 +1,13 @@
+#pragma once
+
+// Stand-in for the openFrameworks umbrella header.
+
+#include "ofColor.h"
+#include "ofEvent.h"
+#include "ofJson.h"
+#include "ofLog.h"
+#include "ofMath.h"
+#include "ofParameter.h"
+#include "ofRectangle.h"
+#include "ofUtils.h"
+#include "ofVectorMath.h"
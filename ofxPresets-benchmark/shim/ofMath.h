@@ -0,0 +1,36 @@
+#pragma once
+
+// Minimal stand-in for the openFrameworks math helpers.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+inline std::mt19937& ofShimRandomEngine() {
+    static std::mt19937 engine(0);
+    return engine;
+}
+
+inline void ofSeedRandom(int seed) { ofShimRandomEngine().seed(static_cast<unsigned>(seed)); }
+
+inline float ofRandom(float min, float max) {
+    if (min == max) return min;
+    if (min > max) std::swap(min, max);
+    return std::uniform_real_distribution<float>(min, max)(ofShimRandomEngine());
+}
+inline float ofRandom(float max) { return ofRandom(0.0f, max); }
+inline float ofRandomf() { return ofRandom(-1.0f, 1.0f); }
+inline float ofRandomuf() { return ofRandom(0.0f, 1.0f); }
+
+template<typename T = float>
+T ofRandomGaussian(T mean, T stddev) {
+    return std::normal_distribution<T>(mean, stddev)(ofShimRandomEngine());
+}
+
+inline float ofLerp(float start, float stop, float amt) { return start + (stop - start) * amt; }
+inline float ofClamp(float value, float min, float max) { return value < min ? min : value > max ? max : value; }
+inline float ofMap(float value, float inputMin, float inputMax, float outputMin, float outputMax, bool clamp = false) {
+    float out = (value - inputMin) / (inputMax - inputMin) * (outputMax - outputMin) + outputMin;
+    if (clamp) out = outputMax < outputMin ? ofClamp(out, outputMax, outputMin) : ofClamp(out, outputMin, outputMax);
+    return out;
+}
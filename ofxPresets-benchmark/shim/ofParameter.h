@@ -0,0 +1,163 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofParameter / ofParameterGroup.
+// Copies of a parameter share the same value, like in openFrameworks.
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ofColor.h"
+#include "ofEvent.h"
+#include "ofMath.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+
+template<typename T> class ofParameter;
+
+class ofAbstractParameter {
+public:
+    virtual ~ofAbstractParameter() = default;
+    virtual std::string getName() const = 0;
+    virtual void setName(const std::string& name) = 0;
+    virtual std::string toString() const = 0;
+    virtual std::shared_ptr<ofAbstractParameter> newReference() const = 0;
+
+    template<typename T>
+    ofParameter<T>& cast() { return static_cast<ofParameter<T>&>(*this); }
+    template<typename T>
+    const ofParameter<T>& cast() const { return static_cast<const ofParameter<T>&>(*this); }
+};
+
+namespace of { namespace priv {
+template<typename T, typename Enable = void>
+struct TypeInfo {
+    static T min() { return T(); }
+    static T max() { return T(); }
+};
+template<typename T>
+struct TypeInfo<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+    static T min() { return std::numeric_limits<T>::lowest(); }
+    static T max() { return std::numeric_limits<T>::max(); }
+};
+template<typename P>
+struct TypeInfo<ofColor_<P>> {
+    static ofColor_<P> min() { return ofColor_<P>(0, 0); }
+    static ofColor_<P> max() { return ofColor_<P>(ofColor_<P>::limit(), ofColor_<P>::limit()); }
+};
+} }
+
+template<typename T>
+class ofParameter : public ofAbstractParameter {
+public:
+    ofParameter() : obj(std::make_shared<Value>()) {}
+    ofParameter(const T& v) : obj(std::make_shared<Value>(v)) {}
+    ofParameter(const std::string& name, const T& v) : obj(std::make_shared<Value>(name, v)) {}
+    ofParameter(const std::string& name, const T& v, const T& min, const T& max) : obj(std::make_shared<Value>(name, v, min, max)) {}
+
+    const T& get() const { return obj->value; }
+    const T* operator->() const { return &obj->value; }
+    operator const T&() const { return obj->value; }
+
+    ofParameter& operator=(const T& v) { return set(v); }
+    ofParameter& operator=(const ofParameter& other) { obj = other.obj; return *this; }
+    ofParameter(const ofParameter& other) = default;
+
+    ofParameter& set(const T& v) {
+        obj->value = v;
+        obj->changedE.notify(obj->value);
+        return *this;
+    }
+    ofParameter& set(const std::string& name, const T& v) {
+        setName(name);
+        return set(v);
+    }
+    ofParameter& set(const std::string& name, const T& v, const T& min, const T& max) {
+        setName(name);
+        setMin(min);
+        setMax(max);
+        return set(v);
+    }
+    void setWithoutEventNotifications(const T& v) { obj->value = v; }
+
+    const T& getMin() const { return obj->min; }
+    const T& getMax() const { return obj->max; }
+    void setMin(const T& min) { obj->min = min; }
+    void setMax(const T& max) { obj->max = max; }
+
+    std::string getName() const override { return obj->name; }
+    void setName(const std::string& name) override { obj->name = name; }
+    std::string toString() const override { return ofToString(obj->value); }
+
+    std::shared_ptr<ofAbstractParameter> newReference() const override {
+        return std::make_shared<ofParameter<T>>(*this);
+    }
+
+    ofEventListener newListener(std::function<void(T&)> listener) { return obj->changedE.newListener(std::move(listener)); }
+
+    template<typename Listener>
+    void addListener(Listener* listener, void (Listener::*method)(T&)) {
+        obj->changedE.add([listener, method](T& v) { (listener->*method)(v); });
+    }
+
+private:
+    struct Value {
+        Value() : value(), min(of::priv::TypeInfo<T>::min()), max(of::priv::TypeInfo<T>::max()) {}
+        Value(const T& v) : value(v), min(of::priv::TypeInfo<T>::min()), max(of::priv::TypeInfo<T>::max()) {}
+        Value(const std::string& name, const T& v) : value(v), min(of::priv::TypeInfo<T>::min()), max(of::priv::TypeInfo<T>::max()), name(name) {}
+        Value(const std::string& name, const T& v, const T& min, const T& max) : value(v), min(min), max(max), name(name) {}
+        T value;
+        T min;
+        T max;
+        std::string name;
+        ofEvent<T> changedE;
+    };
+    std::shared_ptr<Value> obj;
+};
+
+class ofParameterGroup : public ofAbstractParameter {
+public:
+    ofParameterGroup() : obj(std::make_shared<Value>()) {}
+
+    template<typename... Args>
+    void add(ofAbstractParameter& param, Args&... rest) {
+        obj->parameters.push_back(param.newReference());
+        if constexpr (sizeof...(rest) > 0) {
+            add(rest...);
+        }
+    }
+
+    void clear() { obj->parameters.clear(); }
+    size_t size() const { return obj->parameters.size(); }
+
+    ofAbstractParameter& get(size_t index) { return *obj->parameters.at(index); }
+    const ofAbstractParameter& get(size_t index) const { return *obj->parameters.at(index); }
+    ofAbstractParameter& get(const std::string& name) {
+        for (auto& p : obj->parameters) {
+            if (p->getName() == name) return *p;
+        }
+        throw std::out_of_range("ofParameterGroup: no parameter " + name);
+    }
+
+    std::string getName() const override { return obj->name; }
+    void setName(const std::string& name) override { obj->name = name; }
+    std::string toString() const override { return obj->name; }
+
+    std::shared_ptr<ofAbstractParameter> newReference() const override {
+        return std::make_shared<ofParameterGroup>(*this);
+    }
+
+    std::vector<std::shared_ptr<ofAbstractParameter>>::iterator begin() { return obj->parameters.begin(); }
+    std::vector<std::shared_ptr<ofAbstractParameter>>::iterator end() { return obj->parameters.end(); }
+    std::vector<std::shared_ptr<ofAbstractParameter>>::const_iterator begin() const { return obj->parameters.begin(); }
+    std::vector<std::shared_ptr<ofAbstractParameter>>::const_iterator end() const { return obj->parameters.end(); }
+
+private:
+    struct Value {
+        std::string name;
+        std::vector<std::shared_ptr<ofAbstractParameter>> parameters;
+    };
+    std::shared_ptr<Value> obj;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+// Minimal stand-in for openFrameworks' ofRectangle: position and size, equality only.
+
+#include <ostream>
+
+class ofRectangle {
+public:
+    float x = 0, y = 0, width = 0, height = 0;
+
+    ofRectangle() = default;
+    ofRectangle(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
+
+    bool operator==(const ofRectangle& r) const { return x == r.x && y == r.y && width == r.width && height == r.height; }
+    bool operator!=(const ofRectangle& r) const { return !(*this == r); }
+
+    friend std::ostream& operator<<(std::ostream& out, const ofRectangle& r) {
+        return out << r.x << ", " << r.y << ", " << r.width << ", " << r.height;
+    }
+};
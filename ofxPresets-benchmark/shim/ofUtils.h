@@ -0,0 +1,42 @@
+#pragma once
+
+// Minimal stand-in for the openFrameworks time and string helpers.
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+inline std::chrono::steady_clock::time_point& ofShimStartTime() {
+    static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+inline void ofResetElapsedTimeCounter() { ofShimStartTime() = std::chrono::steady_clock::now(); }
+
+inline uint64_t ofGetElapsedTimeMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - ofShimStartTime()).count());
+}
+inline uint64_t ofGetElapsedTimeMillis() { return ofGetElapsedTimeMicros() / 1000; }
+inline float ofGetElapsedTimef() { return ofGetElapsedTimeMicros() / 1000000.0f; }
+
+template<typename T>
+std::string ofToString(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+template<typename T>
+std::string ofToString(const std::vector<T>& values) {
+    std::ostringstream out;
+    out << "{";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i ? ", " : "") << values[i];
+    }
+    out << "}";
+    return out.str();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Minimal stand-in for the glm types openFrameworks exposes through ofVectorMath.h:
+// glm::vec2, vec3, vec4 and glm::quat, with named components and equality only.
+
+#include <ostream>
+
+namespace glm {
+
+struct vec2 {
+    float x = 0, y = 0;
+    vec2() = default;
+    vec2(float x, float y) : x(x), y(y) {}
+    bool operator==(const vec2& v) const { return x == v.x && y == v.y; }
+    bool operator!=(const vec2& v) const { return !(*this == v); }
+};
+
+struct vec3 {
+    float x = 0, y = 0, z = 0;
+    vec3() = default;
+    vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+    bool operator==(const vec3& v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const vec3& v) const { return !(*this == v); }
+};
+
+struct vec4 {
+    float x = 0, y = 0, z = 0, w = 0;
+    vec4() = default;
+    vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    bool operator==(const vec4& v) const { return x == v.x && y == v.y && z == v.z && w == v.w; }
+    bool operator!=(const vec4& v) const { return !(*this == v); }
+};
+
+// glm's constructor order: w first
+struct quat {
+    float x = 0, y = 0, z = 0, w = 1;
+    quat() = default;
+    quat(float w, float x, float y, float z) : x(x), y(y), z(z), w(w) {}
+    bool operator==(const quat& q) const { return x == q.x && y == q.y && z == q.z && w == q.w; }
+    bool operator!=(const quat& q) const { return !(*this == q); }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const vec2& v) { return out << v.x << ", " << v.y; }
+inline std::ostream& operator<<(std::ostream& out, const vec3& v) { return out << v.x << ", " << v.y << ", " << v.z; }
+inline std::ostream& operator<<(std::ostream& out, const vec4& v) { return out << v.x << ", " << v.y << ", " << v.z << ", " << v.w; }
+inline std::ostream& operator<<(std::ostream& out, const quat& q) { return out << q.w << ", " << q.x << ", " << q.y << ", " << q.z; }
+
+}
@@ -0,0 +1,297 @@
+// Fuzzing of the sequence parser, built against the stand-in openFrameworks headers in ../shim
+//
+// Parses random bytes, random strings of the sequence characters and strings generated from the grammar,
+// and checks every sequence that parses: the Cursor gives the steps operator[] gives, toString() parses back
+// to the same steps, and the timeline lays the steps end to end and finds each one at its start time.
+// Prints the inputs that fail a check and exits with 1 if any
+//
+//   make fuzz                              100k iterations, each a generated string and two of noise
+//   make fuzz ARGS="--iterations 1000000 --seed 7"
+
+#include "ofxPresets.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+ofxPresetsRandom generator;
+int failures = 0;
+std::string input; // being checked, printed with the failures
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+void check(bool passed, const char* condition, int line) {
+    static std::string reported;
+    if (!passed && ++failures <= 100 && input != reported) { // the first failure of each input
+        reported = input;
+        std::printf("FAILED line %d: %s\n  input \"", line, condition);
+        for (unsigned char c : input) {
+            std::printf(c >= 32 && c < 127 ? "%c" : "\\x%02x", c);
+        }
+        std::printf("\"\n");
+    }
+}
+
+
+bool nearly(float a, float b, float tolerance) {
+    return std::abs(a - b) <= tolerance * std::max(1.0f, std::abs(a));
+}
+
+/// <summary>
+/// Same step of two sequences, the times and weights within a relative tolerance
+/// </summary>
+bool sameStep(const ofxPresetsSequence& a, const ofxPresetsSequenceStep& x, const ofxPresetsSequence& b, const ofxPresetsSequenceStep& y,
+    float tolerance = 0.0f) {
+    if (x.presetId != y.presetId || x.choiceCount != y.choiceCount ||
+        !nearly(x.hold, y.hold, tolerance) || !nearly(x.transition, y.transition, tolerance)) {
+        return false;
+    }
+    for (uint32_t c = 0; c < x.choiceCount; ++c) {
+        const auto& first = a.choices[x.firstChoice + c];
+        const auto& second = b.choices[y.firstChoice + c];
+        if (first.presetId != second.presetId || !nearly(first.weight, second.weight, tolerance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// <summary>
+/// Indices to check in a sequence: the first steps, the last ones and some in between
+/// </summary>
+std::vector<uint64_t> sampleSteps(uint64_t size) {
+    std::vector<uint64_t> steps;
+    for (uint64_t i = 0; i < std::min<uint64_t>(size, 256); ++i) {
+        steps.push_back(i);
+    }
+    for (uint64_t i = size > 256 ? std::max<uint64_t>(size - 16, 256) : size; i < size; ++i) {
+        steps.push_back(i);
+    }
+    for (int i = 0; i < 64 && size > 272; ++i) {
+        steps.push_back(generator.next() % size);
+    }
+    return steps;
+}
+
+
+void checkCursor(const ofxPresetsSequence& sequence) {
+    // walking from the start, past the end of the first loop
+    ofxPresetsSequence::Cursor cursor(sequence);
+    const uint64_t walk = std::min<uint64_t>(sequence.size() * 2 + 1, 4096);
+    for (uint64_t i = 0; i < walk; ++i, cursor.advance()) {
+        CHECK(cursor.index() == i % sequence.size());
+        CHECK(sameStep(sequence, cursor.step(), sequence, sequence[i]));
+    }
+
+    // from random steps
+    for (int s = 0; s < 8; ++s) {
+        const uint64_t start = generator.next() % (sequence.size() * 3);
+        cursor.seek(start);
+        for (uint64_t i = start; i < start + 64; ++i, cursor.advance()) {
+            CHECK(cursor.index() == i % sequence.size());
+            CHECK(sameStep(sequence, cursor.step(), sequence, sequence[i]));
+        }
+    }
+}
+
+
+void checkRoundTrip(const ofxPresetsSequence& sequence) {
+    const std::string text = sequence.toString();
+    ofxPresetsSequence parsed;
+    ofxPresetsSequenceError error;
+    CHECK(ofxPresetsSequenceParser::parse(text, parsed, error));
+    CHECK(parsed.toString() == text);
+    CHECK(parsed.size() == sequence.size());
+    if (parsed.size() != sequence.size()) {
+        return;
+    }
+
+    // the times and weights are written with 6 decimals, the rest exactly
+    for (uint64_t i : sampleSteps(sequence.size())) {
+        CHECK(sameStep(sequence, sequence[i], parsed, parsed[i], 1e-6f));
+    }
+}
+
+
+void checkTimeline(const ofxPresetsSequence& sequence, float hold, float transition) {
+    ofxPresetsTimeline timeline;
+    timeline.compile(sequence, hold, transition);
+    const double tolerance = 1e-9 * std::max(1.0, timeline.duration());
+
+    for (uint64_t i : sampleSteps(sequence.size())) {
+        const ofxPresetsTimelineEvent event = timeline[i];
+        const ofxPresetsSequenceStep step = sequence[i];
+        CHECK(event.hold == (step.hold < 0.0f ? hold : step.hold));
+        CHECK(event.transition == (step.transition < 0.0f ? transition : step.transition));
+
+        // each step starts where the previous one ends, the last one at the end of the loop
+        const double end = event.start + event.transition + event.hold;
+        const double next = i + 1 < sequence.size() ? timeline[i + 1].start : timeline.duration();
+        CHECK(std::abs(end - next) <= tolerance);
+
+        // found at its time, in any loop
+        const double length = end - event.start;
+        if (length <= tolerance * 4) {
+            continue;
+        }
+        for (double loop : { 0.0, 1.0, 7.0 }) {
+            double stepStart = 0.0;
+            const double offset = loop * timeline.duration();
+            CHECK(timeline.find(offset + event.start + length / 2, stepStart) == i);
+            CHECK(std::abs(stepStart - (offset + event.start)) <= tolerance * (1.0 + loop));
+        }
+    }
+}
+
+
+void checkInput(const std::string& text, bool valid) {
+    input = text;
+    ofxPresetsSequence sequence;
+    ofxPresetsSequenceError error;
+    const bool parsed = ofxPresetsSequenceParser::parse(text, sequence, error);
+    if (valid) {
+        CHECK(parsed);
+    }
+    if (!parsed) {
+        CHECK(error.position <= text.size() && error.message[0] != '\0');
+        return;
+    }
+    if (sequence.empty()) {
+        CHECK(sequence.toString().empty());
+        return;
+    }
+    checkCursor(sequence);
+    checkRoundTrip(sequence);
+    checkTimeline(sequence, generator.uniform(0.0f, 2.0f), generator.below(4) == 0 ? 0.0f : generator.uniform(0.0f, 1.0f));
+    checkTimeline(sequence, 0.0f, 0.0f);
+}
+
+
+std::string randomNumber(int max) {
+    return std::to_string(generator.below(max + 1));
+}
+
+std::string randomDecimal() {
+    switch (generator.below(4)) {
+    case 0: return randomNumber(5);
+    case 1: return randomNumber(3) + "." + randomNumber(99);
+    case 2: return "." + randomNumber(9);
+    default: return randomNumber(2) + ".";
+    }
+}
+
+std::string spaces() {
+    return generator.below(4) == 0 ? std::string(generator.below(3) + 1, ' ') : "";
+}
+
+
+std::string generateStep() {
+    switch (generator.below(9)) {
+    case 0: return randomNumber(20);
+    case 1: return randomNumber(20) + spaces() + "-" + spaces() + randomNumber(20);
+    case 2: return "?";
+    case 3: return "?" + spaces() + "-" + spaces() + (generator.below(3) == 0 ? "?" : randomNumber(6));
+    case 4: return randomNumber(6) + spaces() + "-" + spaces() + "?";
+    case 5: return randomNumber(20) + spaces() + "*";
+    case 6: return "*" + spaces() + randomNumber(20);
+    default: {
+        std::string choices = "?{";
+        for (size_t c = 0, count = generator.below(4) + 1; c < count; ++c) {
+            choices += (c ? "," + spaces() : "") + std::to_string(generator.below(20) + 1);
+            if (generator.below(2) == 0) {
+                choices += spaces() + ":" + spaces() + randomDecimal();
+            }
+        }
+        return choices + spaces() + "}";
+    }
+    }
+}
+
+/// <summary>
+/// A valid sequence string, see ofxPresetsSequenceParser for the syntax
+/// </summary>
+std::string generateList(size_t depth) {
+    std::string list;
+    for (size_t i = 0, count = generator.below(4) + 1; i < count; ++i) {
+        std::string item;
+        if (depth < 4 && generator.below(4) == 0) {
+            item = "(" + spaces() + generateList(depth + 1) + spaces() + ")";
+            if (generator.below(2) == 0) {
+                item += spaces() + (generator.below(2) ? "x" : "X") + spaces() + std::to_string(generator.below(4) + 1);
+            }
+        }
+        else {
+            item = generateStep();
+        }
+        if (generator.below(4) == 0) {
+            switch (generator.below(3)) {
+            case 0: item += "@" + randomDecimal(); break;
+            case 1: item += "@" + randomDecimal() + "/" + randomDecimal(); break;
+            default: item += "@/" + randomDecimal(); break;
+            }
+        }
+        list += (i ? "," + spaces() : spaces()) + item + spaces();
+    }
+    return list;
+}
+
+
+/// <summary>
+/// Noise: any bytes, or the characters of the syntax in any order
+/// </summary>
+std::string randomString() {
+    static const char alphabet[] = "0123456789,,,--??**{}:()xX@/. ";
+    std::string text(generator.below(48), ' ');
+    const bool bytes = generator.below(4) == 0;
+    for (char& c : text) {
+        c = bytes ? static_cast<char>(generator.next() & 0xff) : alphabet[generator.below(sizeof(alphabet) - 1)];
+    }
+    return text;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--iterations") {
+            iterations = std::stoull(argv[i + 1]);
+        }
+        else if (arg == "--seed") {
+            seed = std::stoull(argv[i + 1]);
+        }
+    }
+    ofSetLogLevel(OF_LOG_SILENT);
+    generator.seed(seed);
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        const std::string generated = generateList(0);
+        checkInput(generated, true);
+
+        // ofxPresets::removeInvalidCharacters only drops the spaces of a valid string
+        std::string compact = generated;
+        compact.erase(std::remove(compact.begin(), compact.end(), ' '), compact.end());
+        input = generated;
+        CHECK(ofxPresets::removeInvalidCharacters(generated) == compact);
+
+        const std::string noise = randomString();
+        checkInput(noise, false);
+        checkInput(ofxPresets::removeInvalidCharacters(noise), false);
+    }
+
+    if (failures > 0) {
+        std::printf("%d checks failed, %llu inputs of seed %llu\n", failures,
+            static_cast<unsigned long long>(iterations * 3), static_cast<unsigned long long>(seed));
+        return 1;
+    }
+    std::printf("%llu inputs of seed %llu, all checks passed\n",
+        static_cast<unsigned long long>(iterations * 3), static_cast<unsigned long long>(seed));
+    return 0;
+}
@@ -0,0 +1,545 @@
+// Headless benchmarks of ofxPresets, built against the stand-in openFrameworks headers in ../shim
+//
+// Every result is printed as one JSON object per line on stdout, so two runs can be compared with
+// a plain diff or any JSON tool. Times are in microseconds.
+//
+//   make run                      all benchmarks
+//   make run ARGS="--quick"       fewer iterations and no 100k parameters run
+//   make run ARGS="update"        only the benchmarks whose name contains "update"
+
+#include "ofxPresets.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string folder = "bench-data/";
+std::string filter;
+bool quick = false;
+
+
+/// <summary>
+/// Parameters of a synthetic project: 70% floats, 10% ints, 10% colors and 10% bools
+/// </summary>
+struct Project {
+    std::deque<ofParameter<float>> floats;
+    std::deque<ofParameter<int>> ints;
+    std::deque<ofParameter<ofColor>> colors;
+    std::deque<ofParameter<bool>> bools;
+    ofParameterGroup group;
+
+    explicit Project(size_t count) {
+        group.setName("benchmark");
+        for (size_t i = 0; i < count; ++i) {
+            std::string name = "parameter_" + std::to_string(i);
+            switch (i % 10) {
+            case 7:
+                ints.emplace_back();
+                group.add(ints.back().set(name, 0, 0, 1000));
+                break;
+            case 8:
+                colors.emplace_back();
+                group.add(colors.back().set(name, ofColor(0, 0, 0, 255)));
+                break;
+            case 9:
+                bools.emplace_back();
+                group.add(bools.back().set(name, false));
+                break;
+            default:
+                floats.emplace_back();
+                group.add(floats.back().set(name, 0.0f, 0.0f, 1.0f));
+                break;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Move every parameter to a state derived from seed
+    /// </summary>
+    void fill(int seed) {
+        size_t i = 0;
+        for (auto& p : floats) p = static_cast<float>((i++ * 37 + seed * 11) % 100) / 100.0f;
+        for (auto& p : ints) p = static_cast<int>((i++ * 13 + seed * 7) % 1000);
+        for (auto& p : colors) {
+            int r = (i * 3 + seed) % 256;
+            int g = (i * 5 + seed) % 256;
+            int b = (i * 7 + seed) % 256;
+            p = ofColor(r, g, b, 255);
+            ++i;
+        }
+        for (auto& p : bools) p = ((i++ + seed) % 2) == 0;
+    }
+};
+
+
+struct Stats {
+    size_t iterations = 0;
+    double mean = 0.0;
+    double median = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+Stats summarize(std::vector<double> samples) {
+    Stats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.iterations = samples.size();
+    double total = 0.0;
+    for (double s : samples) {
+        total += s;
+    }
+    stats.mean = total / samples.size();
+    stats.median = samples[samples.size() / 2];
+    stats.min = samples.front();
+    stats.max = samples.back();
+    return stats;
+}
+
+/// <summary>
+/// Time each call of body, in microseconds
+/// </summary>
+template<typename Body>
+Stats measure(size_t iterations, Body&& body) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body(i);
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    return summarize(samples);
+}
+
+bool enabled(const std::string& name) {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+/// <summary>
+/// Print one result line. extra is appended as is, i.e. ",\"format\":\"json\""
+/// </summary>
+void report(const std::string& name, size_t parameters, const Stats& stats, const std::string& extra = "") {
+    std::printf("{\"benchmark\":\"%s\",\"parameters\":%zu,\"iterations\":%zu,"
+        "\"mean_us\":%.3f,\"median_us\":%.3f,\"min_us\":%.3f,\"max_us\":%.3f%s}\n",
+        name.c_str(), parameters, stats.iterations, stats.mean, stats.median, stats.min, stats.max, extra.c_str());
+    std::fflush(stdout);
+}
+
+size_t scaled(size_t parameters, size_t budget) {
+    // roughly the same work per size: budget parameter updates in total, at least 5 iterations
+    size_t iterations = std::max<size_t>(5, budget / parameters);
+    return quick ? std::max<size_t>(3, iterations / 10) : iterations;
+}
+
+std::string projectFolder(size_t parameters) {
+    return folder + std::to_string(parameters) + "/";
+}
+
+
+/// <summary>
+/// One frame of a running transition: interpolation, easing and setting the changed parameters
+/// </summary>
+void benchmarkUpdate(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    auto clock = std::make_shared<ofxPresetsManualClock>();
+    manager.setClock(clock);
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+
+    project.fill(1);
+    manager.savePreset(1);
+    manager.waitForSaves();
+    project.fill(2);
+
+    size_t frames = scaled(parameters, 20000000);
+    manager.applyPreset(1, static_cast<float>(frames + 1) / 60.0f); // never reaches the end while measured
+    Stats stats = measure(frames, [&](size_t) {
+        clock->advance(1.0 / 60.0);
+        manager.update();
+    });
+    report("update", parameters, stats);
+}
+
+
+/// <summary>
+/// One frame of a transition of color parameters only, blended in the given color space
+/// </summary>
+void benchmarkUpdateColors(size_t parameters, ofxPresetsColorSpace space) {
+    std::deque<ofParameter<ofColor>> colors;
+    ofParameterGroup group;
+    group.setName("benchmark");
+    for (size_t i = 0; i < parameters; ++i) {
+        colors.emplace_back();
+        group.add(colors.back().set("color_" + std::to_string(i), ofColor(i % 256, (i * 3) % 256, (i * 7) % 256, 255)));
+    }
+
+    ofxPresets manager;
+    auto clock = std::make_shared<ofxPresetsManualClock>();
+    manager.setClock(clock);
+    std::string colorsFolder = projectFolder(parameters) + "colors/";
+    std::filesystem::create_directories(colorsFolder);
+    manager.setFolderPath(colorsFolder);
+    manager.setup(group);
+    manager.setColorSpace(space);
+
+    manager.savePreset(1);
+    manager.waitForSaves();
+    for (size_t i = 0; i < parameters; ++i) {
+        colors[i] = ofColor((i * 5) % 256, (i * 11) % 256, (i * 13) % 256, 128);
+    }
+
+    size_t frames = scaled(parameters, 2000000);
+    manager.applyPreset(1, static_cast<float>(frames + 1) / 60.0f);
+    Stats stats = measure(frames, [&](size_t) {
+        clock->advance(1.0 / 60.0);
+        manager.update();
+    });
+    report("update_colors", parameters, stats, space == ofxPresetsColorSpace::OKLab ? ",\"color_space\":\"oklab\"" : ",\"color_space\":\"rgb\"");
+}
+
+
+/// <summary>
+/// The same frame with the interpolation computed on the worker thread, against the real clock.
+/// Between two updates the frame thread spins for frameWork, standing for the drawing of the app,
+/// which is when the worker computes the next frame. latency_us is the mean of how late the applied values were
+/// </summary>
+void benchmarkUpdateThreaded(size_t parameters) {
+    const auto frameWork = std::chrono::microseconds(500);
+
+    Project project(parameters);
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+    manager.setThreadedInterpolation();
+
+    project.fill(1);
+    manager.savePreset(1);
+    manager.waitForSaves();
+    project.fill(2);
+
+    size_t frames = std::min<size_t>(scaled(parameters, 20000000), quick ? 100 : 1000);
+    manager.applyPreset(1, 1000.0f);
+    manager.update(); // the first frame of a transition is not threaded
+
+    double latency = 0.0;
+    std::vector<double> samples;
+    for (size_t i = 0; i < frames; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        manager.update();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        latency += std::abs(manager.getInterpolationLatency());
+
+        // not measured: stands for the rest of the frame
+        while (std::chrono::steady_clock::now() < end + frameWork) {
+        }
+    }
+
+    char extra[64];
+    std::snprintf(extra, sizeof(extra), ",\"latency_us\":%.3f", latency / frames * 1e6);
+    report("update_threaded", parameters, summarize(samples), extra);
+}
+
+
+/// <summary>
+/// Interrupting a running transition with a small preset of 100 floats, the way a controller fires presets:
+/// the cost should follow the size of the preset, not the size of the project
+/// </summary>
+void benchmarkRetarget(ofxPresets& manager, std::shared_ptr<ofxPresetsManualClock> clock, size_t parameters) {
+    ofJson values;
+    for (size_t i = 0, floats = 0; i < parameters && floats < 100; ++i) {
+        if (i % 10 < 7) {
+            values["parameter_" + std::to_string(i)] = static_cast<float>(floats++ % 10) / 10.0f;
+        }
+    }
+    ofJson preset;
+    preset["benchmark"] = values;
+    std::ofstream(projectFolder(parameters) + "03.json") << preset.dump();
+    manager.enablePresetBank();
+
+    manager.applyPreset(1, 1.0f);
+    clock->advance(1.0 / 60.0);
+    manager.update();
+    size_t iterations = scaled(100, 200000);
+    Stats stats = measure(iterations, [&](size_t) {
+        manager.applyPreset(3, 1.0f);
+    });
+    report("applyPreset_retarget", parameters, stats, ",\"preset_parameters\":100");
+}
+
+
+/// <summary>
+/// Applying a preset: cold reads and decodes the file on each call, warm takes it decoded from the preset bank
+/// </summary>
+void benchmarkApplyPreset(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    auto clock = std::make_shared<ofxPresetsManualClock>();
+    manager.setClock(clock);
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+
+    project.fill(1);
+    manager.setPresetFormat(ofxPresetsFileFormat::Json);
+    manager.savePreset(1);
+    manager.setPresetFormat(ofxPresetsFileFormat::Binary);
+    manager.savePreset(2);
+    manager.waitForSaves();
+
+    size_t iterations = scaled(parameters, 2000000);
+
+    if (enabled("applyPreset_cold")) {
+        report("applyPreset_cold", parameters, measure(iterations, [&](size_t) { manager.applyPreset(1, 1.0f); }), ",\"format\":\"json\"");
+        report("applyPreset_cold", parameters, measure(iterations, [&](size_t) { manager.applyPreset(2, 1.0f); }), ",\"format\":\"binary\"");
+    }
+    if (enabled("applyPreset_warm")) {
+        manager.enablePresetBank();
+        report("applyPreset_warm", parameters, measure(iterations, [&](size_t i) { manager.applyPreset(1 + i % 2, 1.0f); }));
+    }
+    if (enabled("applyPreset_retarget")) {
+        benchmarkRetarget(manager, clock, parameters);
+    }
+}
+
+
+/// <summary>
+/// Starting a mutation of the current values
+/// </summary>
+void benchmarkMutate(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+    project.fill(1);
+
+    manager.setSeed(0); // the mutations draw from the generator of the manager, not ofRandom
+    report("mutate", parameters, measure(scaled(parameters, 2000000), [&](size_t) { manager.mutate(0.2f); }));
+}
+
+
+/// <summary>
+/// Moving the weights of a blend of 4 presets, the way a fader or an XY pad drives it every frame
+/// </summary>
+void benchmarkBlend(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+    for (int id = 1; id <= 4; ++id) {
+        project.fill(id);
+        manager.savePreset(id);
+    }
+    manager.waitForSaves();
+    manager.setBlend({ {1, 1.0f}, {2, 1.0f}, {3, 1.0f}, {4, 1.0f} }); // presets read once
+
+    Stats stats = measure(scaled(parameters, 2000000), [&](size_t i) {
+        float w = static_cast<float>(i % 100) / 100.0f;
+        manager.setBlend({ {1, w}, {2, 1.0f - w}, {3, 0.5f * w}, {4, 0.25f} });
+    });
+    report("setBlend", parameters, stats, ",\"presets\":4");
+}
+
+
+/// <summary>
+/// Baking a sequence of 3 presets to a 60 fps track, with the speed against real time,
+/// and one frame of playing the track back
+/// </summary>
+void benchmarkBake(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    auto clock = std::make_shared<ofxPresetsManualClock>();
+    manager.setClock(clock);
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+    for (int id = 1; id <= 3; ++id) {
+        project.fill(id);
+        manager.savePreset(id);
+    }
+    manager.waitForSaves();
+    manager.loadSequence("1, 2, 3");
+    manager.playSequence(1.0f, 2.0f);
+    manager.stopSequence();
+
+    const double fps = 60.0;
+    const size_t frames = std::clamp<size_t>(20000000 / parameters, 60, 3600);
+    const std::string trackPath = projectFolder(parameters) + "sequence.track";
+    Stats stats = measure(quick ? 2 : 5, [&](size_t) {
+        manager.bakeSequence(trackPath, fps, frames / fps);
+    });
+    char extra[96];
+    std::snprintf(extra, sizeof(extra), ",\"frames\":%zu,\"realtime_x\":%.1f", frames, frames / fps / (stats.median * 1e-6));
+    report("bakeSequence", parameters, stats, extra);
+
+    if (enabled("update_track")) {
+        manager.playTrack(trackPath, true);
+        report("update_track", parameters, measure(scaled(parameters, 20000000), [&](size_t) {
+            clock->advance(1.0 / fps);
+            manager.update();
+        }));
+        manager.stopTrack();
+    }
+}
+
+
+/// <summary>
+/// Saving: the call itself (values captured, write queued) and the complete crash safe write to the disk
+/// </summary>
+void benchmarkSavePreset(size_t parameters) {
+    Project project(parameters);
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(parameters));
+    manager.setup(project.group);
+    project.fill(1);
+
+    size_t iterations = scaled(parameters, 1000000);
+    for (auto format : { ofxPresetsFileFormat::Json, ofxPresetsFileFormat::Binary }) {
+        std::string name = format == ofxPresetsFileFormat::Json ? ",\"format\":\"json\"" : ",\"format\":\"binary\"";
+        manager.setPresetFormat(format);
+
+        std::vector<double> samples;
+        for (size_t i = 0; i < iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            manager.savePreset(3);
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            manager.waitForSaves(); // not measured, the next sample starts with an idle writer
+        }
+        report("savePreset", parameters, summarize(samples), name);
+
+        report("savePreset_durable", parameters, measure(iterations, [&](size_t) {
+            manager.savePreset(3);
+            manager.waitForSaves();
+        }), name);
+    }
+}
+
+
+/// <summary>
+/// Loading a sequence string of every token kind: numbers, ranges, random and mutated steps,
+/// and with extended, repeated groups, step times and weighted random choices
+/// </summary>
+void benchmarkParseSequence(size_t tokens, bool extended) {
+    std::string sequence;
+    const size_t kinds = extended ? 7 : 4;
+    for (size_t i = 0; i < tokens; ++i) {
+        if (i) {
+            sequence += ", ";
+        }
+        switch (i % kinds) {
+        case 0: sequence += std::to_string(1 + i % 9); break;
+        case 1: sequence += std::to_string(1 + i % 5) + "-" + std::to_string(4 + i % 5); break;
+        case 2: sequence += "?"; break;
+        case 3: sequence += std::to_string(1 + i % 9) + "*"; break;
+        case 4: sequence += "(1, 2, " + std::to_string(1 + i % 9) + ")x4"; break;
+        case 5: sequence += std::to_string(1 + i % 9) + "@2.0/0.5"; break;
+        case 6: sequence += "?{1, 4:2, " + std::to_string(1 + i % 9) + "}"; break;
+        }
+    }
+
+    ofParameter<float> parameter;
+    ofParameterGroup group;
+    group.setName("benchmark");
+    group.add(parameter.set("parameter", 0.0f, 0.0f, 1.0f));
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(1));
+    manager.setup(group);
+
+    Stats stats = measure(scaled(tokens, 20000000), [&](size_t) { manager.loadSequence(sequence); });
+    double bytesPerSecond = sequence.size() / (stats.median * 1e-6);
+    char extra[128];
+    std::snprintf(extra, sizeof(extra), ",\"tokens\":%zu,\"syntax\":\"%s\",\"steps\":%zu,\"mb_per_s\":%.3f",
+        tokens, extended ? "extended" : "basic", static_cast<size_t>(manager.getSequence().size()), bytesPerSecond / (1024.0 * 1024.0));
+    report("parseSequence", 0, stats, extra);
+}
+
+
+/// <summary>
+/// A sequence of millions of steps written in a few tokens: loading it, and seeking to random times of it
+/// </summary>
+void benchmarkLongSequence() {
+    ofParameter<float> parameter;
+    ofParameterGroup group;
+    group.setName("benchmark");
+    group.add(parameter.set("parameter", 0.0f, 0.0f, 1.0f));
+    ofxPresets manager;
+    manager.setFolderPath(projectFolder(1));
+    manager.setup(group);
+    manager.setSequencePrefetch(0);
+
+    const std::string sequence = "1-1000000, ?-500000, ((1, 2)x1000, 3@1/0.5)x1000";
+    Stats load = measure(quick ? 200 : 2000, [&](size_t) { manager.loadSequence(sequence); });
+    const auto& loaded = manager.getSequence();
+    char extra[160];
+    std::snprintf(extra, sizeof(extra), ",\"steps\":%zu,\"segments\":%zu,\"bytes\":%zu",
+        static_cast<size_t>(loaded.size()), loaded.segments.size(),
+        loaded.segments.size() * sizeof(ofxPresetsSequenceSegment) + loaded.children.size() * sizeof(uint32_t));
+    report("loadSequence_long", 0, load, extra);
+
+    const double duration = manager.getSequenceDuration();
+    report("seek_long", 0, measure(quick ? 2000 : 20000, [&](size_t i) {
+        manager.seek(duration * ((i * 7919) % 10007) / 10007.0);
+    }));
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        }
+        else if (arg == "--folder" && i + 1 < argc) {
+            folder = argv[++i];
+            if (folder.back() != '/') {
+                folder += "/";
+            }
+        }
+        else {
+            filter = arg;
+        }
+    }
+
+    ofSetLogLevel(OF_LOG_SILENT);
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+
+    std::vector<size_t> sizes = { 100, 10000, 100000 };
+    if (quick) {
+        sizes.pop_back();
+    }
+
+    for (size_t parameters : sizes) {
+        if (enabled("update")) benchmarkUpdate(parameters);
+        if (enabled("update_threaded")) benchmarkUpdateThreaded(parameters);
+        if (enabled("update_colors")) {
+            benchmarkUpdateColors(parameters / 10, ofxPresetsColorSpace::RGB);
+            benchmarkUpdateColors(parameters / 10, ofxPresetsColorSpace::OKLab);
+        }
+        if (enabled("applyPreset")) benchmarkApplyPreset(parameters);
+        if (enabled("mutate")) benchmarkMutate(parameters);
+        if (enabled("setBlend")) benchmarkBlend(parameters);
+        if (enabled("bakeSequence") || enabled("update_track")) benchmarkBake(parameters);
+        if (enabled("savePreset")) benchmarkSavePreset(parameters);
+    }
+    if (enabled("parseSequence")) {
+        benchmarkParseSequence(1000, false);
+        benchmarkParseSequence(100000, false);
+        benchmarkParseSequence(100000, true);
+    }
+    if (enabled("loadSequence_long") || enabled("seek_long")) {
+        benchmarkLongSequence();
+    }
+
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,344 @@
+// Headless tests of ofxPresets, built against the stand-in openFrameworks headers in ../shim
+//
+//   make test      build and run, prints the failed checks and exits with 1 if any
+
+#include "ofxPresets.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+void check(bool passed, const char* condition, int line) {
+    if (!passed) {
+        std::printf("FAILED line %d: %s\n", line, condition);
+        ++failures;
+    }
+}
+
+std::string testFolder(const std::string& name) {
+    std::string folder = "test-data/" + name + "/";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    return folder;
+}
+
+std::vector<uint8_t> readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+
+/// <summary>
+/// Parameters of the tests: a float, an int, a color and a bool, in this slot order
+/// </summary>
+struct Project {
+    ofParameter<float> a;
+    ofParameter<int> b;
+    ofParameter<ofColor> c;
+    ofParameter<bool> d;
+    ofParameterGroup group;
+    std::shared_ptr<ofxPresetsManualClock> clock = std::make_shared<ofxPresetsManualClock>();
+    ofxPresets manager;
+
+    explicit Project(const std::string& folder) {
+        group.setName("test");
+        group.add(a.set("a", 0.0f, 0.0f, 100.0f));
+        group.add(b.set("b", 0, 0, 100));
+        group.add(c.set("c", ofColor(0, 0, 0, 255)));
+        group.add(d.set("d", false));
+        manager.setClock(clock);
+        manager.setFolderPath(folder);
+        manager.setup(group);
+    }
+};
+
+
+/// <summary>
+/// Binary presets with a matching schema hash but damaged slots are rejected, not applied
+/// </summary>
+void testCorruptedBinaryPresets() {
+    const std::vector<uint8_t> lanes = { 2, 1, 4, 0 }; // float, int, color and bool slots of Project
+    ofxPresetsTargetSet targets;
+    int64_t intValue = 7;
+    float floatValue = 0.5f;
+    targets.ints.add(1, &intValue);
+    targets.floats.add(0, &floatValue);
+
+    std::vector<uint8_t> bytes;
+    ofxPresetsBinary::encode(42, targets, bytes);
+    ofxPresetsTargetSet decoded;
+    std::string error;
+    CHECK(ofxPresetsBinary::decode(bytes.data(), bytes.size(), 42, lanes, decoded, error));
+    CHECK(decoded.ints.size() == 1 && decoded.ints.values[0] == 7);
+
+    // no bools, so the slot of the int comes right after the header
+    const size_t intSlot = sizeof(ofxPresetsBinary::Header);
+    auto withSlot = [&](uint32_t slot) {
+        std::vector<uint8_t> corrupted = bytes;
+        std::memcpy(corrupted.data() + intSlot, &slot, sizeof(slot));
+        return corrupted;
+    };
+
+    std::vector<uint8_t> outOfRange = withSlot(999);
+    CHECK(!ofxPresetsBinary::decode(outOfRange.data(), outOfRange.size(), 42, lanes, decoded, error));
+    CHECK(decoded.empty());
+
+    std::vector<uint8_t> wrongType = withSlot(0); // the float slot, in the int section
+    CHECK(!ofxPresetsBinary::decode(wrongType.data(), wrongType.size(), 42, lanes, decoded, error));
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 6);
+    CHECK(!ofxPresetsBinary::decode(truncated.data(), truncated.size(), 42, lanes, decoded, error));
+
+    // through the manager: the preset is refused and the parameters stay as they are
+    std::string folder = testFolder("corrupted");
+    Project project(folder);
+    project.manager.setPresetFormat(ofxPresetsFileFormat::Binary);
+    project.a = 40.0f;
+    project.b = 60;
+    project.manager.savePreset(1);
+    project.manager.waitForSaves();
+
+    std::vector<uint8_t> saved = readBytes(folder + "01.bin");
+    CHECK(saved.size() > sizeof(ofxPresetsBinary::Header) + 8);
+    // first section holds the bool, its slot is 3: point it past the table
+    uint32_t slot = 0;
+    std::memcpy(&slot, saved.data() + sizeof(ofxPresetsBinary::Header), sizeof(slot));
+    CHECK(slot == 3);
+    slot = 1000000;
+    std::memcpy(saved.data() + sizeof(ofxPresetsBinary::Header), &slot, sizeof(slot));
+    writeBytes(folder + "01.bin", saved);
+
+    project.a = 10.0f;
+    project.b = 20;
+    project.manager.applyPreset(1, 0.0f);
+    project.clock->advance(1.0);
+    project.manager.update();
+    CHECK(project.a == 10.0f && project.b == 20);
+}
+
+
+
+/// <summary>
+/// Presets 1 to 5, a = 10 * id, b = id and a color of their own
+/// </summary>
+void savePresets(Project& project) {
+    for (int id = 1; id <= 5; ++id) {
+        project.a = 10.0f * id;
+        project.b = id;
+        project.c = ofColor(40 * id, 200 - 30 * id, 20 * id, 255);
+        project.manager.savePreset(id);
+    }
+    project.manager.waitForSaves();
+}
+
+
+/// <summary>
+/// Seeking to a time gives the values playing gave at that time, random and mutation steps included,
+/// without transitionFinished for the jump. Step times do not change interpolationDuration
+/// </summary>
+void testSeekMatchesPlayback() {
+    std::string folder = testFolder("seek");
+    const std::string steps = "?, 3*, ?{1, 4:2}, 2@1/0.25, ?-2";
+    const double loopDuration = 5 * 1.5 + 1.25; // 6 steps, hold 1 s and transition 0.5 s but the fourth
+
+    // the values in the middle of the hold of each step, for three loops
+    std::vector<double> times;
+    std::vector<std::pair<float, int>> played;
+    {
+        Project project(folder);
+        savePresets(project);
+        project.manager.setSeed(9);
+        project.a = 0.0f;
+        project.b = 0;
+        CHECK(project.manager.loadSequence(steps));
+        project.manager.playSequence(1.0f, 0.5f);
+
+        double start = 0.0;
+        for (int loop = 0; loop < 3; ++loop) {
+            for (int step = 0; step < 6; ++step) {
+                const double transition = step == 3 ? 0.25 : 0.5;
+                times.push_back(start + transition + 0.5);
+                start += transition + 1.0;
+            }
+        }
+        CHECK(std::abs(start - 3 * loopDuration) < 1e-9);
+
+        double time = 0.0;
+        for (double sample : times) {
+            while (time + 0.05 < sample) {
+                time += 0.05;
+                project.clock->set(time);
+                project.manager.update();
+            }
+            time = sample;
+            project.clock->set(time);
+            project.manager.update();
+            played.push_back({ project.a.get(), project.b.get() });
+        }
+        CHECK(project.manager.interpolationDuration.get() == 0.5f);
+    }
+
+    Project project(folder);
+    project.manager.setSeed(9);
+    project.manager.sequencePresetDuration = 1.0f; // the times of playSequence(1.0f, 0.5f), for the seeks while stopped
+    project.manager.interpolationDuration = 0.5f;
+    CHECK(project.manager.loadSequence(steps));
+    int finished = 0;
+    project.manager.transitionFinished.newListener([&finished]() { ++finished; });
+
+    // out of order, playing or stopped
+    const size_t order[] = { 12, 3, 17, 0, 7, 15, 1, 16, 8, 4 };
+    for (size_t k = 0; k < sizeof(order) / sizeof(order[0]); ++k) {
+        if (k == 5) {
+            project.manager.playSequence(1.0f, 0.5f);
+        }
+        project.manager.seek(times[order[k]]);
+        CHECK(project.a.get() == played[order[k]].first);
+        CHECK(project.b.get() == played[order[k]].second);
+    }
+    CHECK(finished == 0);
+}
+
+
+/// <summary>
+/// A preset applied right after it is saved has the saved values, read from memory while the save worker is busy
+/// </summary>
+void testApplyWhileSaving() {
+    std::string folder = testFolder("saving");
+    Project project(folder);
+    savePresets(project);
+    project.manager.setPresetFormat(ofxPresetsFileFormat::Binary);
+    project.manager.interpolationDuration = 0.0f;
+
+    for (int round = 0; round < 20; ++round) {
+        project.a = 50.0f + round;
+        project.b = 70 + round;
+        project.manager.savePreset(2); // json to binary, the json file is removed once written
+        project.manager.savePreset(5);
+        project.a = 0.0f;
+        project.b = 0;
+
+        project.manager.applyPreset(5, 0.0f);
+        project.clock->advance(0.1);
+        project.manager.update();
+        CHECK(project.a == 50.0f + round && project.b == 70 + round);
+
+        project.manager.mutateFromPreset(-2, 0.0f);
+        project.clock->advance(1.0);
+        project.manager.update();
+        CHECK(project.a == 50.0f + round && project.b == 70 + round);
+    }
+    project.manager.waitForSaves();
+
+    // and from the files once written
+    project.a = 0.0f;
+    project.manager.applyPreset(5, 0.0f);
+    project.clock->advance(0.1);
+    project.manager.update();
+    CHECK(project.a == 69.0f && project.b == 89);
+}
+
+
+/// <summary>
+/// A baked track plays the values the sequence reaches, the easing runs on the calling thread,
+/// and a track whose slots do not match the parameters is not played
+/// </summary>
+void testBakedTrack() {
+    std::string folder = testFolder("track");
+    Project project(folder);
+    savePresets(project);
+    project.manager.setSeed(3);
+    project.c = ofColor(250, 0, 120, 255); // not a color of the presets, the mutation starts from the one of preset 4
+    project.manager.sequencePresetDuration = 1.0f;
+    project.manager.interpolationDuration = 0.5f;
+    CHECK(project.manager.loadSequence("1, ?, 4*, 2"));
+
+    std::vector<std::thread::id> easingThreads;
+    project.manager.setEasingFunction([&easingThreads](float t) {
+        easingThreads.push_back(std::this_thread::get_id());
+        return t * t;
+    });
+    const std::string trackPath = folder + "show.track";
+    CHECK(project.manager.bakeSequence(trackPath, 10.0));
+    CHECK(easingThreads.size() == 60);
+    CHECK(std::count(easingThreads.begin(), easingThreads.end(), std::this_thread::get_id()) == static_cast<long>(easingThreads.size()));
+
+    // the middle of the hold of each step
+    for (double time : { 1.0, 2.5, 4.0, 5.5 }) {
+        CHECK(project.manager.playTrack(trackPath));
+        project.clock->advance(time);
+        project.manager.update();
+        const float a = project.a.get();
+        const int b = project.b.get();
+        const ofColor c = project.c.get();
+        project.manager.stopTrack();
+        project.manager.seek(time);
+        CHECK(std::abs(project.a.get() - a) < 1e-4f && project.b.get() == b);
+        CHECK(project.c.get() == c);
+    }
+
+    std::vector<uint8_t> baked = readBytes(trackPath);
+    auto withBoolSlot = [&](uint32_t slot) {
+        std::vector<uint8_t> corrupted = baked;
+        std::memcpy(corrupted.data() + sizeof(ofxPresetsTrack::Header), &slot, sizeof(slot));
+        writeBytes(trackPath, corrupted);
+    };
+    withBoolSlot(1000000);
+    CHECK(!project.manager.playTrack(trackPath));
+    withBoolSlot(0); // the float slot, in the bool section
+    CHECK(!project.manager.playTrack(trackPath));
+    CHECK(!project.manager.isPlayingTrack());
+
+    // frame counts of no frames, and so large that their size wraps around
+    auto withFrames = [&](uint64_t frames) {
+        std::vector<uint8_t> corrupted = baked;
+        std::memcpy(corrupted.data() + offsetof(ofxPresetsTrack::Header, frames), &frames, sizeof(frames));
+        writeBytes(trackPath, corrupted);
+    };
+    for (uint64_t frames : { uint64_t(0), uint64_t(61), ~uint64_t(0) / 13 + 2, ~uint64_t(0) }) {
+        withFrames(frames);
+        CHECK(!project.manager.playTrack(trackPath));
+        CHECK(!project.manager.playTrack(trackPath, true));
+    }
+
+    // parameters set up again while playing stop the track
+    writeBytes(trackPath, baked);
+    CHECK(project.manager.playTrack(trackPath));
+    ofParameter<float> e;
+    project.group.add(e.set("e", 0.0f, 0.0f, 1.0f));
+    project.manager.setup(project.group);
+    project.clock->advance(0.1);
+    project.manager.update();
+    CHECK(!project.manager.isPlayingTrack());
+}
+
+}
+
+
+int main() {
+    testCorruptedBinaryPresets();
+    testSeekMatchesPlayback();
+    testBakedTrack();
+    testApplyWhileSaving();
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -87,7 +87,6 @@ void ofApp::setup(){
 void ofApp::update(){
 	manager.update();
 	currentPreset = ofToString(manager.getCurrentPreset());
-	internalSequence = ofToString(manager.sequence.get());
     playing = ofToString(manager.isPlayingSequence() ? "true" : "false");
 }
 
@@ -119,6 +118,7 @@ void ofApp::keyReleased(ofKeyEventArgs& e) {
 
 	if (e.keycode == 'S') {
 		manager.loadSequence(ofToString(sequenceInput.get()));
+		internalSequence = manager.getSequence().toString();
 		manager.playSequence();
 	}
 
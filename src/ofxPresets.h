@@ -1,9 +1,30 @@
 #pragma once
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "ofJson.h"
 #include "ofLog.h"
 #include "ofxPresetsParametersBase.h"
+#include "ofxPresetsInterpolator.h"
+#include "ofxPresetsBlend.h"
+#include "ofxPresetsSequenceParser.h"
+#include "ofxPresetsRandom.h"
+#include "ofxPresetsTimeline.h"
+#include "ofxPresetsTrack.h"
+#include "ofxPresetsVectorTypes.h"
+#include "ofxPresetsBinary.h"
+#include "ofxPresetsArchive.h"
+#include "ofxPresetsClock.h"
+#include "ofxPresetsStats.h"
+#include "ofxPresetsCommandQueue.h"
+#include "ofxPresetsWorker.h"
 #include "ofxSEasing.h"
 
 
@@ -14,70 +35,316 @@ const float DEFAULT_SEQUENCE_PRESET_DURATION = 5.0f;
 const float DEFAULT_INTERPOLATION_DURATION = 3.0f;
 const float DEFAULT_MUTATION_PERCENTAGE = 0.1f;
 const int MAX_RANDOM_PRESET = 16;
+const int DEFAULT_SEQUENCE_PREFETCH = 2;
+const size_t BINARY_PRESET_THRESHOLD = 1000; // parameters from which presets are saved as binary files, in Auto format
+const size_t COMMAND_QUEUE_CAPACITY = 256; // calls queued from other threads between two updates
+const double MAX_PREDICTED_FRAME = 0.1; // seconds, longest frame the threaded interpolation computes ahead
+const size_t BAKE_BATCH_BYTES = 16 * 1024 * 1024; // frames rendered in parallel between two writes of a baked track
+
+
+// Preset file format, see ofxPresetsBinary for the binary layout
+enum class ofxPresetsFileFormat {
+    Json,   // NN.json, human readable
+    Binary, // NN.bin, memory mapped when applied
+    Auto    // json, or binary from BINARY_PRESET_THRESHOLD parameters
+};
+
+
+// Parameter type, resolved once when the binding table is built
+enum class ofxPresetsParameterType {
+    Bool,
+    Int,
+    Float,
+    Color,
+    Double, // new types go last, so the schema hash of existing preset files does not change
+    Vec2,
+    Vec3,
+    Vec4,
+    FloatColor,
+    Rectangle,
+    Quat
+};
+
+
+// One entry of the binding table: a managed parameter with its type already resolved,
+// so the per-frame paths can switch on the tag instead of comparing typeid names
+struct ofxPresetsBinding {
+    std::string group;
+    std::string key;
+    ofxPresetsParameterType type;
+    ofAbstractParameter* param;
+
+    // typed access, the type was checked with dynamic_cast when the table was built
+    template<typename T>
+    ofParameter<T>& as() const { return *static_cast<ofParameter<T>*>(param); }
+};
+
+
+// A preset held in memory by the preset bank
+struct ofxPresetsBankEntry {
+    ofxPresetsTargetSet targets;
+    std::filesystem::file_time_type modified;
+    uint64_t archiveOffset = 0; // payload offset when read from the archive, changes with every save
+};
+
+
+// A sequence step decoded ahead of time by the prefetch worker
+struct ofxPresetsPrefetchedStep {
+    uint64_t stepNumber = 0;        // steps from the start of the sequence, see sequenceStepNumber
+    int presetId = 0;               // concrete id, random steps are already picked. Negative for mutations
+    bool valid = false;             // false if the preset could not be read
+    std::atomic<bool> ready{ false }; // set by the worker once the fields above are final
+    ofxPresetsTargetSet targets;
+    ofxPresetsRandom random{ 0 };   // of the step, after its pick: a mutation draws from it when applied
+};
+
+
+// Result of a savePreset, sent with the presetSaved event
+struct ofxPresetsSaveEventArgs {
+    int id = 0;
+    bool success = false;
+    std::string location; // preset file, or archive file
+};
+
+
+// A savePreset snapshot, written by the save worker
+struct ofxPresetsSaveJob {
+    int id = 0;
+    bool binary = false;
+    bool compactJson = false;
+    bool toArchive = false;
+    std::string filePath;       // not used for the archive
+    std::string otherFilePath;  // the same preset in the other format, removed once saved
+    ofxPresetsTargetSet targets;
+};
+
+
+// A call queued from another thread, run by update() on the frame thread
+struct ofxPresetsCommand {
+    enum Type : uint8_t {
+        ApplyPreset,
+        Mutate,
+        MutateFromPreset,
+        LoadSequence,
+        PlaySequence,
+        StopSequence,
+        Stop,
+        Blend,
+        Seek
+    };
+
+    Type type = Stop;
+    int id = 0;
+    float duration = -1.0f;       // transition duration, negative for the current interpolationDuration
+    float presetDuration = -1.0f; // PlaySequence only, negative for the current sequencePresetDuration
+    float percentage = -1.0f;     // mutations, negative for the current mutationPercentage
+    std::string sequence;         // LoadSequence only
+    std::vector<std::pair<int, float>> weights; // Blend only
+    double time = 0.0;            // Seek only
+};
 
 
-// This struct stores the target values for the interpolation,
-// and a starting time
-struct InterpolationData {
-    float startTime = 0.0f;
-    std::unordered_map<std::string, float> targetValues;
+// Bindings are stored contiguously per group, this keeps the range of each one
+struct ofxPresetsBindingGroup {
+    std::string name;
+    size_t begin = 0;
+    size_t end = 0;
 };
 
 
 class ofxPresets {
 
 private:
-    void saveParametersToJson(const std::string& jsonFilePath);
-    void applyJsonToParameters(const std::string& jsonFilePath, float interpolationDuration);
+    void encodePreset(const ofxPresetsTargetSet& targets, bool binary, bool compact, std::vector<uint8_t>& bytes);
+    bool readPreset(int id, ofxPresetsTargetSet& targets);
+    bool readPresetFile(const std::string& filePath, ofxPresetsTargetSet& targets);
+    bool readJsonFile(const std::string& jsonFilePath, ofxPresetsTargetSet& targets);
+    bool readBinaryFile(const std::string& binaryFilePath, ofxPresetsTargetSet& targets);
+    void decodeJson(ofJson& j, ofxPresetsTargetSet& targets);
+    ofJson encodeJson(const ofxPresetsTargetSet& targets);
+    void captureTargets(ofxPresetsTargetSet& targets);
+    void applyTargets(const ofxPresetsTargetSet& targets, float duration);
+    // multi-component types, see ofxPresetsVectorType
+    void decodeVector(const ofJson& value, size_t slot, ofxPresetsTargetSet::Lane<float>& lane);
+    void encodeVectors(ofJson& j, const ofxPresetsTargetSet::Lane<float>& lane);
+    template<typename T>
+    void captureVector(size_t slot, ofxPresetsTargetSet::Lane<float>& lane);
+    template<typename T>
+    void storeVectorValues(ofxPresetsInterpolator::Lane<float>& lane);
+    template<typename T>
+    void applyVectorValues(const ofxPresetsInterpolator::Lane<float>& lane);
+    bool applyPresetValues(int id, float duration);
 
     std::string convertIDtoJSonFilename(int id);
+    std::string convertIDtoBinaryFilename(int id);
+    int convertFilenameToID(const std::string& filename, bool& binary);
+    std::string presetFilePath(int id);
+    bool isBinaryFilePath(const std::string& filePath) const;
     bool fileExist(const std::string& jsonFilePath);
 	std::string folderPath = "data\\";
 
+    ofxPresetsFileFormat presetFormat = ofxPresetsFileFormat::Auto;
+    bool useBinaryFormat(ofxPresetsFileFormat format) const;
+
+    // optional single file storage, replaces the preset folder while open
+    ofxPresetsArchive archive;
+    bool readArchivePreset(int id, ofxPresetsTargetSet& targets);
+
+    // write-behind saving, snapshots are serialized and written on a worker thread
+    ofxPresetsWorker saveWorker;
+    std::atomic<int> pendingSaves{ 0 };
+    std::mutex completedSavesMutex;
+    std::vector<ofxPresetsSaveEventArgs> completedSaves;
+    std::mutex savingPresetsMutex;
+    std::map<int, std::shared_ptr<const ofxPresetsSaveJob>> savingPresets; // the snapshots not written yet, read instead of their files
+    bool compactJson = false;
+    bool readSavingPreset(int id, ofxPresetsTargetSet& targets);
+    void writeSaveJob(const ofxPresetsSaveJob& job);
+    void processCompletedSaves();
+    void flushSaves();
+
     std::string sequenceString;
-    int sequenceIndex = 0;
+    ofxPresetsSequence sequence;         // the loaded sequence, as segments
+    ofxPresetsSequence parsedSequence;   // parse buffer, swapped in when a string is valid
+    ofxPresetsSequence::Cursor sequenceCursor{ sequence }; // the step to play next
+    uint64_t sequenceStepNumber = 0; // the same step counted from the start of the sequence, across loops
     int lastAppliedPreset = 0;
 
-    float lastUpdateTime = 0.0f;
-    bool isTransitioning = false;  // flag to know if we are transitioning(interpolating) in the sequence
-    bool isPlaying = false;
+    // time source, and the time of the last update (all transitions and sequence steps are timed from it)
+    std::shared_ptr<ofxPresetsClock> clock = std::make_shared<ofxPresetsElapsedClock>();
+    double currentTime = clock->now();
 
-    std::unordered_map<std::string, InterpolationData> interpolationDataMap;
-    std::unordered_map<std::string, std::unordered_map<std::string, float>> currentParameterValues;
-    void storeCurrentValues();
-    int getRandomPreset(int lowerPreset, int higherPreset);
+    ofxPresetsStats stats; // see OFX_PRESETS_STATS
 
-    std::vector<ofxPresetsParametersBase*>* params; // local reference to the parameters
+    // calls from other threads, run at the start of update()
+    ofxPresetsCommandQueue<ofxPresetsCommand> commands{ COMMAND_QUEUE_CAPACITY };
+    bool queueCommand(ofxPresetsCommand&& command);
+    void runQueuedCommands();
+    bool isPlaying = false;
 
-    std::vector<int> parseSequence(std::string& input);
-    std::vector<std::string> splitString(const std::string& str, char delimiter) const;
-    std::vector<int> unfoldRanges(std::string& str);
-    std::vector<int> unfoldRandomRange(std::vector<std::string> randomRange);
+    // the sequence laid out in time, steps are scheduled from sequenceStartTime so frame times do not add up
+    ofxPresetsTimeline timeline;
+    double sequenceStartTime = 0.0;
+    double nextStepStart = 0.0;    // from sequenceStartTime
+    float sequenceTransition = DEFAULT_INTERPOLATION_DURATION; // for the steps without their own
+    void compileTimeline();
+    void startSequenceStep(double stepStart);
+    void seekSequenceStep(double time, double& stepStart);
+    void completeTransition();
+
+    // a baked track played back instead of the sequence, see playTrack()
+    ofxPresetsTrack track;
+    ofxPresetsInterpolator trackLanes; // values of the current frame
+    ofxPresetsTargetSet::Lane<uint8_t> trackBools;
+    bool trackPlaying = false;
+    bool trackLoop = false;
+    double trackStartTime = 0.0;
+    int64_t trackFrame = -1;
+    void updateTrack();
+
+    ofxPresetsInterpolator interpolator; // target and start values of the running transition
+    float transitionDuration = DEFAULT_INTERPOLATION_DURATION; // of the running transition, sequence steps have their own
+    void storeCurrentValues();
+    int getRandomPreset(int lowerPreset, int higherPreset, ofxPresetsRandom& generator);
+    void startPreset(int id, float duration, ofxPresetsRandom& generator);
+    void mutateFromPreset(int id, float percentage, float duration, ofxPresetsRandom& generator);
+
+    // sorted ids of the existing preset files, built with a single folder scan
+    std::vector<int> presetIndex;
+    std::vector<int> binaryPresetIndex; // the ones saved as binary files
+    bool presetIndexBuilt = false;
+    void buildPresetIndex();
+    void addToPresetIndex(int id, bool binary);
+    void removeFromPresetIndex(int id);
+
+    std::vector<ofxPresetsParametersBase*>* params = nullptr; // local reference to the parameters
+
+    // compiled binding table, built once on setup
+    std::vector<ofxPresetsBinding> bindings;
+    std::vector<ofxPresetsBindingGroup> bindingGroups;
+    std::unordered_map<std::string, std::unordered_map<std::string, size_t>> bindingSlots; // group -> key -> slot, used when reading presets
+    uint64_t schemaHash = 0; // identifies the slot layout, binary presets are only valid for the same one
+    std::vector<uint8_t> bindingLanes; // lane of each slot, in the order of ofxPresetsTargetSet::forEachLane, to check the slots of binary files
+    void buildBindings();
+    static uint8_t laneOf(ofxPresetsParameterType type);
+
+    // opt-in in-memory preset bank, every preset file decoded against the binding slots
+    bool presetBankEnabled = false;
+    std::map<int, ofxPresetsBankEntry> presetBank;
+    void loadBankEntry(int id);
+
+    // presets of the last setBlend, resolved to slots once
+    ofxPresetsBlend blend;
+    std::vector<float> blendWeights;
+    bool buildBlend(const std::vector<int>& ids);
+    bool fetchPreset(int id, ofxPresetsTargetSet& targets);
+    void applyBoolValues(const std::vector<uint32_t>& slots, const uint8_t* values);
+    void invalidateBlend(int id);
+
+    int pickSequencePreset(const ofxPresetsSequenceStep& step, ofxPresetsRandom& generator);
+    ofxPresetsRandom stepRandom(uint64_t stepNumber) const { return ofxPresetsRandom(random.getSeed(), stepNumber); }
     
-    std::function<float(float)> easingFunction = ofxSEeasing::easeInOutCubic;
+    std::function<float(float)> easingFunction;  // user easing, evaluated once per frame when set
+    ofxSEeasing::EasingCurve easingCurve = ofxSEeasing::eased<ofxSEeasing::InOutCubic>;
 
     void onPresetFinished();
     void onTransitionFinished();
     //void onSequenceFinished(); // not implemented
 
     void updateParameters();
+    void applyLaneValues(const ofxPresetsInterpolator& lanes);
     void updateSequence();
+
+    // batched change notification, see setBatchNotifications()
+    bool batchNotifications = false;
+    std::vector<size_t> changedSlots;
+    template<typename T>
+    void setParameter(size_t slot, const T& value);
+    void notifyChangedParameters();
     void advanceSequenceIndex();
+    void applySequenceStep(float duration);
+    void mutateTargets(ofxPresetsInterpolator& lanes, float percentage, ofxPresetsRandom& generator);
+    template<typename T, typename Value>
+    void mutateNumbers(ofxPresetsInterpolator::Lane<Value>& lane, const float*& noise);
+    void mutateColor(float* rgba, const float* noise);
+
+    // random presets and mutations, see setSeed(). Sequence steps draw from a stream of its seed each, see stepRandom()
+    ofxPresetsRandom random;
+    std::vector<float> mutationNoise; // normal values of one mutation, generated at once
+
+    // sequence look-ahead, decoded on a worker thread while the current preset holds
+    int sequencePrefetch = DEFAULT_SEQUENCE_PREFETCH;
+    std::deque<std::shared_ptr<ofxPresetsPrefetchedStep>> prefetchedSteps;
+    ofxPresetsWorker prefetchWorker;
+    void prefetchSequence();
+    void cancelPrefetch();
+    void decodePrefetchedStep(ofxPresetsPrefetchedStep& step, const std::string& filePath);
+
+    // interpolation computed ahead on a worker thread, see setThreadedInterpolation()
+    bool threadedInterpolation = false;
+    ofxPresetsWorker interpolationWorker;
+    bool interpolationPending = false; // the worker was given the next frame, its result is not applied yet
+    float pendingT = 0.0f;             // normalized time of the pending values
+    double pendingTime = 0.0;          // clock time the pending values were computed for
+    double frameInterval = 0.0;        // between the last two updates, to predict the next one
+    double interpolationLatency = 0.0;
+    float interpolationTime(double time) const;
+    void evaluateInterpolation(float t, bool toBack);
+    void dropPendingInterpolation();
 
 public:
     ofxPresets() {}
 
     ~ofxPresets() {
+        prefetchWorker.stop();
+        saveWorker.wait(); // pending saves are written, not dropped
+        saveWorker.stop();
         stop();
+        interpolationWorker.stop();
         if (params) {
             delete params;
         }
-        if (!interpolationDataMap.empty()) {
-            interpolationDataMap.clear();
-        }
-        if (!currentParameterValues.empty()) {
-            currentParameterValues.clear();
-        }
+        interpolator.clear();
     }
 
     void setup(ofParameterGroup& parameters);
@@ -86,47 +353,116 @@ public:
     void setup(std::vector<ofxPresetsParametersBase*>& parameters);
 
     void update();
+    void update(double now);
+
+    void setClock(std::shared_ptr<ofxPresetsClock> clock);
+    std::shared_ptr<ofxPresetsClock> getClock() const { return clock; }
+    double getTime() const { return currentTime; }
+
+    void setThreadedInterpolation(bool threaded = true);
+    bool isThreadedInterpolation() const { return threadedInterpolation; }
+    double getInterpolationLatency() const { return interpolationLatency; }
+
+    const ofParameterGroup& getStats() const { return stats.getGroup(); }
+    void resetStats() { stats.reset(); }
 
     void applyPreset(int id);
     void applyPreset(int id, float duration);
+
+    bool queueApplyPreset(int id, float duration = -1.0f);
+    bool queueMutate(float percentage = -1.0f);
+    bool queueMutateFromPreset(int id, float percentage);
+    bool queueLoadSequence(const std::string& sequenceString);
+    bool queuePlaySequence(float presetDuration = -1.0f, float transitionDuration = -1.0f);
+    bool queueStopSequence();
+    bool queueStop();
+    bool queueBlend(const std::vector<std::pair<int, float>>& weights);
+    bool queueSeek(double time);
     void savePreset(int id);
+    void waitForSaves();
+    void setCompactJson(bool compact = true);
     void deletePreset(int id);
     void clonePresetTo(int from, int to);
 
-    void loadSequence(const std::string& sequenceString);
+    bool openArchive(const std::string& archivePath);
+    void closeArchive();
+    bool isUsingArchive() const { return archive.isOpen(); }
+    void importPresetsToArchive();
+    void exportArchiveToFolder();
+    void compactArchive();
+
+    void setPresetFormat(ofxPresetsFileFormat format);
+    ofxPresetsFileFormat getPresetFormat() const { return presetFormat; }
+    bool convertPreset(int id, ofxPresetsFileFormat format);
+    void convertAllPresets(ofxPresetsFileFormat format);
+
+    bool loadSequence(const std::string& sequenceString);
+    static std::string removeInvalidCharacters(const std::string& input);
     void playSequence();
     void playSequence(float sequenceDuration, float transitionDuration);
     void stopSequence();
+    void seek(double time);
+    double getSequenceTime() const { return isPlaying ? currentTime - sequenceStartTime : 0.0; }
+    double getSequenceDuration() const { return timeline.duration(); }
+
+    bool bakeSequence(const std::string& trackPath, double fps, double duration = -1.0);
+    bool playTrack(const std::string& trackPath, bool loop = false);
+    void stopTrack();
+    bool isPlayingTrack() const { return trackPlaying; }
     void stopInterpolating();
     void stop();
+    void setSequencePrefetch(int steps);
 
     void mutate();
     void mutate(float percentage);
 
     void mutateFromPreset(int id, float percentage);
 
-	ofParameter<std::vector<int>> sequence;
+    void setSeed(uint64_t seed);
+    uint64_t getSeed() const { return random.getSeed(); }
+
+    bool setBlend(const std::vector<std::pair<int, float>>& weights);
+    void clearBlend();
+
     int getCurrentPreset();
-    static std::string removeInvalidCharacters(const std::string& input);
 
-    bool isInterpolating() { return !interpolationDataMap.empty(); } // for when parameters are being interpolated
+    bool isInterpolating() { return interpolator.isActive(); } // for when parameters are being interpolated
     bool isPlayingSequence() const { return isPlaying; }
-    int getSequenceIndex() const { return sequenceIndex; }
+    int getSequenceIndex() const { return static_cast<int>(sequenceCursor.index()); }
+    const ofxPresetsSequence& getSequence() const { return sequence; }
+    void setSequence(const std::vector<int>& steps);
 
     bool presetExist(int id);
+    const std::vector<int>& getPresetIds();
+    void refreshPresetIndex();
 
     void setFolderPath(const std::string& path);
 
+    void enablePresetBank(bool enable = true);
+    bool isPresetBankEnabled() const { return presetBankEnabled; }
+    void refreshPresetBank();
+
     ofParameter<float> sequencePresetDuration = DEFAULT_SEQUENCE_PRESET_DURATION;
     ofParameter<float> interpolationDuration = DEFAULT_INTERPOLATION_DURATION;
     ofParameter<float> mutationPercentage = DEFAULT_MUTATION_PERCENTAGE;
 
     void setEasingFunction(std::function<float(float)> func);
+    template<typename Easing>
+    void setEasing();
+    void setColorSpace(ofxPresetsColorSpace space);
+    ofxPresetsColorSpace getColorSpace() const { return interpolator.colorSpace; }
+
+    void setBatchNotifications(bool batch = true);
+    bool isBatchingNotifications() const { return batchNotifications; }
+    size_t getParameterCount() const { return bindings.size(); }
+    ofAbstractParameter& getParameter(size_t slot) { return *bindings[slot].param; }
 
     ofEvent<void> sequencePresetFinished;
     ofEvent<void> transitionFinished;
     ofEvent<void> sequenceFinished;
 	ofEvent<void> presetAppicationStarted;
+    ofEvent<ofxPresetsSaveEventArgs> presetSaved;
+    ofEvent<std::vector<size_t>> parametersChanged;
 };
 
 
@@ -135,10 +471,35 @@ public:
 /// </summary>
 /// <param name="func">Take one from the ofxSEasing or use yours</param>
 void ofxPresets::setEasingFunction(std::function<float(float)> func) {
+    dropPendingInterpolation();
     easingFunction = func;
 }
 
 
+/// <summary>
+/// Set the easing by its ofxSEeasing tag, so it gets inlined into the interpolation kernel
+/// i.e. setEasing<ofxSEeasing::InOutQuad>()
+/// </summary>
+template<typename Easing>
+void ofxPresets::setEasing() {
+    dropPendingInterpolation();
+    easingFunction = nullptr;
+    easingCurve = ofxSEeasing::eased<Easing>;
+}
+
+
+/// <summary>
+/// Set the color space the ofColor and ofFloatColor parameters are interpolated and mutated in
+/// </summary>
+/// <param name="space">RGB (default) blends the sRGB channels, OKLab blends perceptually</param>
+void ofxPresets::setColorSpace(ofxPresetsColorSpace space) {
+    dropPendingInterpolation();
+    interpolator.colorSpace = space;
+    interpolator.colorsChanged();
+    blend.invalidate(); // its colors are stored in the previous space
+}
+
+
 /// <summary>
 /// Setup the preset manager from a vector containing the parameters structs
 /// </summary>
@@ -148,6 +509,7 @@ void ofxPresets::setEasingFunction(std::function<float(float)> func) {
 /// </param>
 void ofxPresets::setup(std::vector<ofxPresetsParametersBase*>& parameters) {
     this->params = &parameters;
+    buildBindings();
 }
 
 
@@ -157,6 +519,7 @@ void ofxPresets::setup(std::vector<ofxPresetsParametersBase*>& parameters) {
 /// <param name="parameters"></param>
 void ofxPresets::setup(ofxPresetsParametersBase& parameters) {
     this->params = new std::vector<ofxPresetsParametersBase*>{ &parameters };
+    buildBindings();
 }
 
 
@@ -176,6 +539,7 @@ void ofxPresets::setup(ofParameterGroup& parameters) {
     auto paramGroup = new p(parameters);
 
     this->params = new std::vector<ofxPresetsParametersBase*>{ paramGroup };
+    buildBindings();
 }
 
 
@@ -198,624 +562,2286 @@ void ofxPresets::setup(std::vector<ofParameterGroup>& parameters) {
         allParameters.push_back(param);
     }
     this->params = &allParameters;
+    buildBindings();
 }
 
 
 /// <summary>
-/// Update interpolations and sequence
+/// Lane of a parameter type in ofxPresetsTargetSet, numbered in the order of forEachLane
 /// </summary>
-void ofxPresets::update() {
-    updateParameters();
-    updateSequence();
+uint8_t ofxPresets::laneOf(ofxPresetsParameterType type) {
+    switch (type) {
+    case ofxPresetsParameterType::Bool: return 0;
+    case ofxPresetsParameterType::Int: return 1;
+    case ofxPresetsParameterType::Float: return 2;
+    case ofxPresetsParameterType::Double: return 3;
+    case ofxPresetsParameterType::Color: return 4;
+    case ofxPresetsParameterType::Vec2: return 5;
+    case ofxPresetsParameterType::Vec3: return 6;
+    case ofxPresetsParameterType::Vec4: return 7;
+    case ofxPresetsParameterType::FloatColor: return 8;
+    case ofxPresetsParameterType::Rectangle: return 9;
+    case ofxPresetsParameterType::Quat: return 10;
+    }
+    return 0;
 }
 
 
+/// <summary>
+/// Resolve every managed parameter into the binding table
+/// Types are checked here once, so the rest of the manager can work with slot indices
+/// </summary>
+void ofxPresets::buildBindings() {
+    cancelPrefetch();
+    prefetchWorker.wait(); // the workers read the bindings
+    flushSaves();
 
-#pragma region ParameterHandling
+    bindings.clear();
+    bindingGroups.clear();
+    bindingSlots.clear();
+    bindingLanes.clear();
+    blend.invalidate();
 
+    for (auto& paramGroup : *params) {
+        ofxPresetsBindingGroup bindingGroup;
+        bindingGroup.name = paramGroup->groupName;
+        bindingGroup.begin = bindings.size();
 
-/// <summary>
-/// Apply the values from a JSON file into to the parameter interpolation map
-/// </summary>
-/// <param name="jsonFilePath">Full path to the json file</param>
-void ofxPresets::applyJsonToParameters(const std::string& jsonFilePath, float duration) {
-    ofLog(OF_LOG_NOTICE) << "ofxPresets::applyJsonToParameters:: Applying preset to parameters from " << jsonFilePath;
+        // sorted keys, so the slot order does not depend on the hash map
+        std::vector<std::string> keys;
+        for (auto& [key, param] : paramGroup->parameterMap) {
+            if (param) { // Check if the parameter is not null
+                keys.push_back(key);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
 
-    // Read the JSON file
-    std::ifstream file(jsonFilePath);
-    if (!file.is_open()) {
-        ofLogError("ofxPresets::applyJsonToParameters") << "Could not open JSON file";
-        return;
-    }
+        for (auto& key : keys) {
+            auto param = paramGroup->parameterMap[key];
 
-    // Parse the JSON file
-    ofJson j;
-    file >> j;
+            ofxPresetsBinding binding{ paramGroup->groupName, key, ofxPresetsParameterType::Bool, param };
+            if (dynamic_cast<ofParameter<bool>*>(param)) {
+                binding.type = ofxPresetsParameterType::Bool;
+            }
+            else if (dynamic_cast<ofParameter<int>*>(param)) {
+                binding.type = ofxPresetsParameterType::Int;
+            }
+            else if (dynamic_cast<ofParameter<float>*>(param)) {
+                binding.type = ofxPresetsParameterType::Float;
+            }
+            else if (dynamic_cast<ofParameter<ofColor>*>(param)) {
+                binding.type = ofxPresetsParameterType::Color;
+            }
+            else if (dynamic_cast<ofParameter<double>*>(param)) {
+                binding.type = ofxPresetsParameterType::Double;
+            }
+            else if (dynamic_cast<ofParameter<glm::vec2>*>(param)) {
+                binding.type = ofxPresetsParameterType::Vec2;
+            }
+            else if (dynamic_cast<ofParameter<glm::vec3>*>(param)) {
+                binding.type = ofxPresetsParameterType::Vec3;
+            }
+            else if (dynamic_cast<ofParameter<glm::vec4>*>(param)) {
+                binding.type = ofxPresetsParameterType::Vec4;
+            }
+            else if (dynamic_cast<ofParameter<ofFloatColor>*>(param)) {
+                binding.type = ofxPresetsParameterType::FloatColor;
+            }
+            else if (dynamic_cast<ofParameter<ofRectangle>*>(param)) {
+                binding.type = ofxPresetsParameterType::Rectangle;
+            }
+            else if (dynamic_cast<ofParameter<glm::quat>*>(param)) {
+                binding.type = ofxPresetsParameterType::Quat;
+            }
+            else {
+                ofLog(OF_LOG_VERBOSE) << "ofxPresets::buildBindings:: Unsupported type for " << key << " in " << paramGroup->groupName;
+                continue;
+            }
 
-    interpolationDataMap.clear();
+            bindingSlots[paramGroup->groupName][key] = bindings.size();
+            bindingLanes.push_back(laneOf(binding.type));
+            bindings.push_back(binding);
+        }
 
-	storeCurrentValues(); // needed for interpolation
+        bindingGroup.end = bindings.size();
+        bindingGroups.push_back(bindingGroup);
+    }
 
-    interpolationDuration.set(duration);
+    // group, key and type of every slot, in slot order
+    schemaHash = ofxPresetsBinary::hash(nullptr, 0);
+    for (auto& binding : bindings) {
+        const uint8_t type = static_cast<uint8_t>(binding.type);
+        schemaHash = ofxPresetsBinary::hash(binding.group.c_str(), binding.group.size() + 1, schemaHash);
+        schemaHash = ofxPresetsBinary::hash(binding.key.c_str(), binding.key.size() + 1, schemaHash);
+        schemaHash = ofxPresetsBinary::hash(&type, 1, schemaHash);
+    }
 
-    // Iterate over all items in the JSON
-    for (auto& [group, v] : j.items()) {  // first level is the parameter group
+    // bank entries are resolved against the slots, decode them again
+    if (presetBankEnabled) {
+        presetBank.clear();
+        refreshPresetBank();
+    }
+}
 
-        // Iterate over all parameter groups to find the corresponding 1st level set from the json
-        for (auto& paramGroup : *params) {
-            if (paramGroup->groupName == group) {
 
-                InterpolationData interpolationData;
-                interpolationData.startTime = ofGetElapsedTimef();
+/// <summary>
+/// Update interpolations and sequence, at the time of the clock
+/// </summary>
+void ofxPresets::update() {
+    update(clock->now());
+}
 
-                // iterate over all items in the group
-                for (auto& [key, value] : j[group].items()) {
 
-                    // store actual param key and value
-                    auto param = paramGroup->parameterMap[key];
-                    if (param == nullptr) {
-                        ofLog(OF_LOG_VERBOSE) << "ofxPresets::applyJsonToParameters::" << "Preset key " << key << " not found in " << group;
-                        continue;
-                    }
+/// <summary>
+/// Update interpolations and sequence at a given time, in seconds.
+/// Transitions and sequence steps started until the next update are timed from it
+/// </summary>
+void ofxPresets::update(double now) {
+    frameInterval = std::clamp(now - currentTime, 0.0, MAX_PREDICTED_FRAME);
+    currentTime = now;
+    runQueuedCommands();
+    processCompletedSaves();
+    updateTrack();
+    updateParameters();
+    updateSequence();
+    OFX_PRESETS_STATS_DO(stats.endFrame());
+}
 
-                    // cast to apply the value
-                    const std::string paramTypeName = typeid(*param).name(); // get the type of the parameter to cast it
-
-                    try {
-                        if (paramTypeName == typeid(ofParameter<bool>).name()) {
-                            dynamic_cast<ofParameter<bool>*>(param)->set(value.get<bool>());
-                        }
-                        else if (paramTypeName == typeid(ofParameter<int>).name()) {
-                            //dynamic_cast<ofParameter<int>*>(param)->set(value.get<int>());
-                            interpolationData.targetValues[key] = value.get<int>();
-                        }
-                        else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                            //dynamic_cast<ofParameter<float>*>(param)->set(value.get<float>());
-                            interpolationData.targetValues[key] = value.get<float>();
-                        }
-                        else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                            ofColor color;
-                            color.setHex(value.get<int>());
-                            if (j[group].contains(key + "_alpha")) {
-                                color.a = j[group][key + "_alpha"].get<int>();
-                            } else {
-                                color.a = 255;
-                            }
-                            interpolationData.targetValues[key] = color.getHex();
-                            interpolationData.targetValues[key + "_alpha"] = color.a;
-                        }
-                    }
-                    catch (const std::exception& e) {
-                        ofLogError("ofxPresets::applyJsonToParameters") << "Error applying value for key " << key << ": " << e.what();
-                    }
-                }
 
-                interpolationDataMap[group] = interpolationData;
-            }
-        }
-    }
+/// <summary>
+/// Replace the time source, e.g. an ofxPresetsManualClock to step at a fixed rate or offline.
+/// A null clock restores the openFrameworks elapsed time
+/// </summary>
+void ofxPresets::setClock(std::shared_ptr<ofxPresetsClock> newClock) {
+    clock = newClock ? newClock : std::make_shared<ofxPresetsElapsedClock>();
+    currentTime = clock->now();
 }
 
 
 
+#pragma region CommandQueue
+
+
 /// <summary>
-/// Save the current values of the parameters to use them as a reference for interpolation
+/// Queue applyPreset from any thread, it runs on the next update()
 /// </summary>
-void ofxPresets::storeCurrentValues() {
-    for (auto& paramGroup : *params) {
-        std::unordered_map<std::string, float> groupValues;
-        for (auto& [key, param] : paramGroup->parameterMap) {
-            if (param) { // Check if the parameter is not null
-                const std::string paramTypeName = typeid(*param).name();
-                if (paramTypeName == typeid(ofParameter<int>).name()) {
-                    groupValues[key] = dynamic_cast<ofParameter<int>*>(param)->get();
-                }
-                else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                    groupValues[key] = dynamic_cast<ofParameter<float>*>(param)->get();
-				}
-                else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                    ofColor color = dynamic_cast<ofParameter<ofColor>*>(param)->get();
-                    groupValues[key] = color.getHex();
-                    groupValues[key + "_alpha"] = color.a;
-                }
-            }
-        }
-        currentParameterValues[paramGroup->groupName] = groupValues;
-    }
+/// <param name="duration">Negative (default) for the interpolationDuration at that time</param>
+/// <returns>false if the queue is full, the call is dropped</returns>
+bool ofxPresets::queueApplyPreset(int id, float duration) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::ApplyPreset;
+    command.id = id;
+    command.duration = duration;
+    return queueCommand(std::move(command));
 }
 
 
+/// <summary>
+/// Queue mutate from any thread, it runs on the next update()
+/// </summary>
+/// <param name="percentage">Negative (default) for the mutationPercentage at that time</param>
+bool ofxPresets::queueMutate(float percentage) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::Mutate;
+    command.percentage = percentage;
+    return queueCommand(std::move(command));
+}
 
 
 /// <summary>
-/// Mutate the parameters with a random value within the min and max range
-/// Uses the global mutationPercentage (Default 0.1)
+/// Queue mutateFromPreset from any thread, it runs on the next update()
 /// </summary>
-void ofxPresets::mutate(){
-	mutate(mutationPercentage);
+bool ofxPresets::queueMutateFromPreset(int id, float percentage) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::MutateFromPreset;
+    command.id = id;
+    command.percentage = percentage;
+    return queueCommand(std::move(command));
 }
 
 
 /// <summary>
-/// Mutate the parameters with a random value within the min and max range
+/// Queue loadSequence from any thread, it runs on the next update()
 /// </summary>
-/// <param name="percentage">This will modify the public mutationPercentage</param>
-void ofxPresets::mutate(float percentage) {
-	ofLog(OF_LOG_VERBOSE) << "ofxPresets::mutate:: Mutating current parameter values with percentage " << percentage;
+bool ofxPresets::queueLoadSequence(const std::string& sequenceString) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::LoadSequence;
+    command.sequence = sequenceString;
+    return queueCommand(std::move(command));
+}
 
-	mutationPercentage.set(percentage);
 
-    storeCurrentValues(); // Store current values as a reference
+/// <summary>
+/// Queue playSequence from any thread, it runs on the next update()
+/// </summary>
+/// <param name="presetDuration">Negative (default) for the sequencePresetDuration at that time</param>
+/// <param name="transitionDuration">Negative (default) for the interpolationDuration at that time</param>
+bool ofxPresets::queuePlaySequence(float presetDuration, float transitionDuration) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::PlaySequence;
+    command.presetDuration = presetDuration;
+    command.duration = transitionDuration;
+    return queueCommand(std::move(command));
+}
 
-    interpolationDataMap.clear(); // Clear any existing interpolation data
 
-    for (auto& paramGroup : *params) {
-        InterpolationData interpolationData;
-        interpolationData.startTime = ofGetElapsedTimef();
+/// <summary>
+/// Queue stopSequence from any thread, it runs on the next update()
+/// </summary>
+bool ofxPresets::queueStopSequence() {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::StopSequence;
+    return queueCommand(std::move(command));
+}
 
-        for (auto& [key, param] : paramGroup->parameterMap) {
-            if (param) { // Check if the parameter is not null
-                const std::string paramTypeName = typeid(*param).name();
-                float currentValue = 0.0f;
-                float minValue = 0.0f;
-                float maxValue = 0.0f;
-
-                if (paramTypeName == typeid(ofParameter<int>).name()) {
-                    auto intParam = dynamic_cast<ofParameter<int>*>(param);
-                    currentValue = intParam->get();
-                    minValue = intParam->getMin();
-                    maxValue = intParam->getMax();
-                }
-                else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                    auto floatParam = dynamic_cast<ofParameter<float>*>(param);
-                    currentValue = floatParam->get();
-                    minValue = floatParam->getMin();
-                    maxValue = floatParam->getMax();
-                }
-				else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-					currentValue = dynamic_cast<ofParameter<ofColor>*>(param)->get().getHue();
-					minValue = 0.0f;
-					maxValue = 255.0f;
-				}
-
-                // Calculate the random mutation
-                float range = maxValue - minValue;
-                float mutation = ofRandomGaussian(0.0f, percentage / 4) * range;
-				float mutatedValue = currentValue + mutation;  // mutation does use the current value
-
-                // Clamp the mutated value within the min and max range
-                mutatedValue = std::clamp(mutatedValue, minValue, maxValue);
-
-                interpolationData.targetValues[key] = mutatedValue;
-
-				// Special case for colors, mutate the brightness and hue
-                if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                    ofColor targetColor = dynamic_cast<ofParameter<ofColor>*>(param)->get();
-                    targetColor.setHue(mutatedValue);
-                    targetColor.setBrightness(mutatedValue-currentValue+ targetColor.getBrightness());
-                    targetColor.a = std::clamp(targetColor.a + ofRandomGaussian(0.0f, percentage / 4) * 255.0f, 0.0f, 255.0f);
-                    interpolationData.targetValues[key] = targetColor.getHex();
-                    interpolationData.targetValues[key + "_alpha"] = targetColor.a;
-                }
-            }
-        }
 
-        interpolationDataMap[paramGroup->groupName] = interpolationData;
-    }
-	// No need to start the interpolation, it will be done on the next update, since InterpolationDataMap is not empty
+/// <summary>
+/// Queue stop from any thread, it runs on the next update()
+/// </summary>
+bool ofxPresets::queueStop() {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::Stop;
+    return queueCommand(std::move(command));
 }
 
 
 /// <summary>
-/// Take an existent preset and mutate the values
+/// Queue setBlend from any thread, it runs on the next update()
 /// </summary>
-/// <param name="id"></param>
-/// <param name="percentage"></param>
-void ofxPresets::mutateFromPreset(int id, float percentage) {
-    ofLog(OF_LOG_VERBOSE) << "ofxPresets::mutateFromPreset:: About to mutate values from the preset " << -id;
-
-    std::string jsonFilePath = convertIDtoJSonFilename(-id);
-    if (!fileExist(jsonFilePath)) {
-        ofLogError("ofxPresets::mutateFromPreset") << "Preset file does not exist for ID: " << id;
-        return;
-    }
+bool ofxPresets::queueBlend(const std::vector<std::pair<int, float>>& weights) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::Blend;
+    command.weights = weights;
+    return queueCommand(std::move(command));
+}
 
-    // Apply the preset without interpolation
-    applyJsonToParameters(jsonFilePath, interpolationDuration);
 
-    // Store current values as a reference
-    storeCurrentValues();
+/// <summary>
+/// Queue seek from any thread, it runs on the next update()
+/// </summary>
+bool ofxPresets::queueSeek(double time) {
+    ofxPresetsCommand command;
+    command.type = ofxPresetsCommand::Seek;
+    command.time = time;
+    return queueCommand(std::move(command));
+}
 
-    // Mutate the parameters with the given percentage
-    mutationPercentage.set(percentage);
 
-	// TODO: this is repeated from the mutate() BUT using different sources, should be a common function
-    for (auto& [group, interpolationData] : interpolationDataMap) {
-        for (auto& [key, targetValue] : interpolationData.targetValues) {
-            float currentValue = currentParameterValues[group][key];
-            float minValue = 0.0f;
-            float maxValue = 0.0f;
-
-            // Determine the parameter type and get min/max values
-            for (auto& paramGroup : *params) {
-                if (paramGroup->groupName == group) {
-                    auto param = paramGroup->parameterMap[key];
-                    if (param) {
-                        const std::string paramTypeName = typeid(*param).name();
-                        if (paramTypeName == typeid(ofParameter<int>).name()) {
-                            auto intParam = dynamic_cast<ofParameter<int>*>(param);
-                            minValue = intParam->getMin();
-                            maxValue = intParam->getMax();
-                        }
-                        else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                            auto floatParam = dynamic_cast<ofParameter<float>*>(param);
-                            minValue = floatParam->getMin();
-                            maxValue = floatParam->getMax();
-						}
-                        else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                            targetValue = dynamic_cast<ofParameter<ofColor>*>(param)->get().getHue();
-                            minValue = 0.0f;
-                            maxValue = 255.0f;
-                        }
-                        // Calculate the random mutation
-                        float range = maxValue - minValue;
-                        float mutation = ofRandomGaussian(0.0f, percentage / 4) * range;
-			            float mutatedValue = targetValue + mutation; // mutationFromPreset does use the target value instead of the current
-
-                        // Clamp the mutated value within the min and max range
-                        mutatedValue = std::clamp(mutatedValue, minValue, maxValue);
-
-                        // Update the target value with the mutated value
-                        interpolationData.targetValues[key] = mutatedValue;
-
-                        // Special case for colors, mutate the brightness and hue
-                        if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                            ofColor targetColor = dynamic_cast<ofParameter<ofColor>*>(param)->get();
-                            
-                            // change the hue
-                            targetColor.setHue(mutatedValue);
-
-							// repeat for brightness
-                            mutation = ofRandomGaussian(0.0f, percentage / 4) * range;
-                            mutatedValue = targetColor.getBrightness() + mutation;
-                            mutatedValue = std::clamp(mutatedValue, 0.0f, 255.0f);
-                            targetColor.setBrightness(mutatedValue);
-
-                            // repeat for saturation
-                            mutation = ofRandomGaussian(0.0f, percentage / 4) * range;
-                            mutatedValue = targetColor.getSaturation() + mutation;
-                            mutatedValue = std::clamp(mutatedValue, 0.0f, 255.0f);
-                            targetColor.setSaturation(mutatedValue);
-
-                            // alpha value
-                            targetColor.a = std::clamp(targetColor.a + ofRandomGaussian(0.0f, percentage / 4) * 255.0f, 0.0f, 255.0f);
-
-                            interpolationData.targetValues[key] = targetColor.getHex();
-                            interpolationData.targetValues[key + "_alpha"] = targetColor.a;
-                        }
-                    }
-                }
-            }
-        }
+bool ofxPresets::queueCommand(ofxPresetsCommand&& command) {
+    if (!commands.push(std::move(command))) {
+        ofLogWarning("ofxPresets::queueCommand") << "Command queue full (" << commands.capacity() << " calls), dropping the call";
+        return false;
     }
+    return true;
 }
 
 
+/// <summary>
+/// Run the calls queued from other threads, in order.
+/// At most one queue capacity per frame, so producers that keep pushing can not hold the frame
+/// </summary>
+void ofxPresets::runQueuedCommands() {
+    ofxPresetsCommand command;
+    for (size_t i = 0; i < commands.capacity() && commands.pop(command); ++i) {
+        float duration = command.duration < 0.0f ? interpolationDuration.get() : command.duration;
+        float percentage = command.percentage < 0.0f ? mutationPercentage.get() : command.percentage;
+
+        switch (command.type) {
+        case ofxPresetsCommand::ApplyPreset:
+            applyPreset(command.id, duration);
+            break;
+        case ofxPresetsCommand::Mutate:
+            mutate(percentage);
+            break;
+        case ofxPresetsCommand::MutateFromPreset:
+            mutateFromPreset(command.id, percentage);
+            break;
+        case ofxPresetsCommand::LoadSequence:
+            loadSequence(command.sequence);
+            break;
+        case ofxPresetsCommand::PlaySequence:
+            playSequence(command.presetDuration < 0.0f ? sequencePresetDuration.get() : command.presetDuration, duration);
+            break;
+        case ofxPresetsCommand::StopSequence:
+            stopSequence();
+            break;
+        case ofxPresetsCommand::Stop:
+            stop();
+            break;
+        case ofxPresetsCommand::Blend:
+            setBlend(command.weights);
+            break;
+        case ofxPresetsCommand::Seek:
+            seek(command.time);
+            break;
+        }
+    }
+}
 
 #pragma endregion
 
 
 
-
-
-
+#pragma region ParameterHandling
 
 
 /// <summary>
-/// Apply a preset to the parameters
-/// Uses the global interpolation duration
+/// Read a preset from the archive when one is open, otherwise from its file
 /// </summary>
-/// <param name="id"></param>
-void ofxPresets::applyPreset(int id) {
-	applyPreset(id, interpolationDuration);
+/// <returns>false if the preset could not be read</returns>
+bool ofxPresets::readPreset(int id, ofxPresetsTargetSet& targets) {
+    if (readSavingPreset(id, targets)) {
+        return true; // saved but maybe not written yet, the snapshot has the values without waiting for the disk
+    }
+    if (archive.isOpen()) {
+        return readArchivePreset(id, targets);
+    }
+    return readPresetFile(presetFilePath(id), targets);
 }
 
+
 /// <summary>
-/// Apply a preset to the parameters
+/// Read a preset file of either format and resolve its values against the binding slots
+/// A binary file that does not match the current parameters falls back to the json file of the same preset, if any
 /// </summary>
-/// <param name="id"></param>
-/// <param name="parameterGroups"></param>
-/// <param name="duration">This will update the global interpolationDuration</param>
-void ofxPresets::applyPreset(int id, float duration) {
-
-    // mutation
-    if (id < 0) {
-        mutateFromPreset(id, mutationPercentage);
-        lastAppliedPreset = id;
-		presetAppicationStarted.notify();
-        return;
+/// <param name="filePath">Full path to the .json or .bin file</param>
+/// <param name="targets">Decoded values</param>
+/// <returns>false if the file could not be read</returns>
+bool ofxPresets::readPresetFile(const std::string& filePath, ofxPresetsTargetSet& targets) {
+    if (!isBinaryFilePath(filePath)) {
+        return readJsonFile(filePath, targets);
     }
 
-    // random preset
-    if (id == 0) {
-        id = getRandomPreset(1, MAX_RANDOM_PRESET);
-	}
+    if (readBinaryFile(filePath, targets)) {
+        return true;
+    }
 
-	// apply preset
-    std::string jsonFilePath = convertIDtoJSonFilename(id);
+    std::string jsonFilePath = std::filesystem::path(filePath).replace_extension(".json").string();
     if (fileExist(jsonFilePath)) {
-        applyJsonToParameters(jsonFilePath, duration);
-        lastAppliedPreset = id;
-        presetAppicationStarted.notify();
-    }
-    else {
-        ofLog(OF_LOG_WARNING) << "ofxPresets::applyPreset:: No json file for preset " << id << " : " << jsonFilePath;
+        ofLog(OF_LOG_NOTICE) << "ofxPresets::readPresetFile:: Using " << jsonFilePath << " instead";
+        return readJsonFile(jsonFilePath, targets);
     }
+    return false;
 }
 
+
 /// <summary>
-/// Find a valid random preset by looking for an existant json file
+/// Read a JSON preset file and resolve its values against the binding slots
 /// </summary>
-/// <returns>After higherPreset^2 unlucky attempts, returns lowerPreset </returns>
-int ofxPresets::getRandomPreset(int lowerPreset = 1, int higherPreset = 10) {
-    int id = ofRandom(lowerPreset, higherPreset);
-	int exitCounter = higherPreset * higherPreset;
-
-    while (!presetExist(id) && exitCounter-- > 0) {
-		id = ofRandom(lowerPreset, higherPreset);
-	}
+/// <param name="jsonFilePath">Full path to the json file</param>
+/// <param name="targets">Decoded values</param>
+/// <returns>false if the file could not be opened or parsed</returns>
+bool ofxPresets::readJsonFile(const std::string& jsonFilePath, ofxPresetsTargetSet& targets) {
+    // Read the JSON file
+    std::string text;
+    {
+        OFX_PRESETS_STATS_TIME(stats, FileIO);
+        std::ifstream file(jsonFilePath, std::ios::binary);
+        if (!file.is_open()) {
+            ofLogError("ofxPresets::readJsonFile") << "Could not open JSON file " << jsonFilePath;
+            return false;
+        }
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    OFX_PRESETS_STATS_DO(stats.addBytesRead(text.size()));
 
-    if (exitCounter <= 0) {
-        ofLogError("ofxPresets::getRandomPreset") << "Could not find valid random preset file";
-        id = lowerPreset;
+    // Parse the JSON file
+    OFX_PRESETS_STATS_TIME(stats, Parse);
+    ofJson j;
+    try {
+        j = ofJson::parse(text);
+    }
+    catch (const std::exception& e) {
+        ofLogError("ofxPresets::readJsonFile") << "Could not parse JSON file " << jsonFilePath << ": " << e.what();
+        return false;
     }
 
-	ofLog(OF_LOG_VERBOSE) << "ofxPresets::getRandomPreset:: Getting random preset " << id;
-    return id;
+    decodeJson(j, targets);
+    return true;
 }
 
 
 /// <summary>
-/// Returns the current preset item in the sequence
-/// Will report the actual preset when 0 (random) is found
+/// Map a binary preset file and copy its values, already in slot order
 /// </summary>
-/// <returns></returns>
-int ofxPresets::getCurrentPreset() {
-    return lastAppliedPreset;
+/// <param name="binaryFilePath">Full path to the bin file</param>
+/// <param name="targets">Decoded values</param>
+/// <returns>false if the file could not be mapped or was saved with other parameters</returns>
+bool ofxPresets::readBinaryFile(const std::string& binaryFilePath, ofxPresetsTargetSet& targets) {
+    ofxPresetsMappedFile file;
+    {
+        OFX_PRESETS_STATS_TIME(stats, FileIO);
+        if (!file.open(binaryFilePath)) {
+            ofLogError("ofxPresets::readBinaryFile") << "Could not read binary file " << binaryFilePath << ": could not map the file";
+            return false;
+        }
+    }
+    OFX_PRESETS_STATS_DO(stats.addBytesRead(file.size()));
+
+    OFX_PRESETS_STATS_TIME(stats, Parse);
+    std::string error;
+    if (!ofxPresetsBinary::decode(file.data(), file.size(), schemaHash, bindingLanes, targets, error)) {
+        ofLogError("ofxPresets::readBinaryFile") << "Could not read binary file " << binaryFilePath << ": " << error;
+        return false;
+    }
+    return true;
 }
 
 
 /// <summary>
-/// Stops the running interpolation
+/// Resolve the values of a parsed preset against the binding slots
 /// </summary>
-void ofxPresets::stopInterpolating() {
-    ofLog(OF_LOG_VERBOSE) << "ofxPresets::stopSequence:: Stopping interpolation";
-    interpolationDataMap.clear();
-}
+/// <param name="j">First level are the group names</param>
+/// <param name="targets">Decoded values, keys without a matching parameter are skipped</param>
+void ofxPresets::decodeJson(ofJson& j, ofxPresetsTargetSet& targets) {
+    targets.clear();
 
-/// <summary>
-/// Stops the running sequence and interpolation
-/// </summary>
-void ofxPresets::stop() {
-    stopInterpolating();
-    stopSequence();
+    // Iterate over all items in the JSON
+    for (auto& [group, v] : j.items()) {  // first level is the parameter group
+
+        // Find the slots for the corresponding 1st level set from the json
+        auto groupSlots = bindingSlots.find(group);
+        if (groupSlots == bindingSlots.end()) {
+            continue;
+        }
+
+        // iterate over all items in the group
+        for (auto& [key, value] : j[group].items()) {
+
+            auto slot = groupSlots->second.find(key);
+            if (slot == groupSlots->second.end()) {
+                ofLog(OF_LOG_VERBOSE) << "ofxPresets::decodeJson::" << "Preset key " << key << " not found in " << group;
+                continue;
+            }
+            auto& binding = bindings[slot->second];
+
+            try {
+                switch (binding.type) {
+                case ofxPresetsParameterType::Bool: {
+                    uint8_t b = value.get<bool>() ? 1 : 0;
+                    targets.bools.add(slot->second, &b);
+                    break;
+                }
+                case ofxPresetsParameterType::Int: {
+                    int64_t i = value.get<int64_t>();
+                    targets.ints.add(slot->second, &i);
+                    break;
+                }
+                case ofxPresetsParameterType::Float: {
+                    float f = value.get<float>();
+                    targets.floats.add(slot->second, &f);
+                    break;
+                }
+                case ofxPresetsParameterType::Double: {
+                    double d = value.get<double>();
+                    targets.doubles.add(slot->second, &d);
+                    break;
+                }
+                case ofxPresetsParameterType::Color: {
+                    ofColor color;
+                    color.setHex(value.get<int>());
+                    if (j[group].contains(key + "_alpha")) {
+                        color.a = j[group][key + "_alpha"].get<int>();
+                    } else {
+                        color.a = 255;
+                    }
+                    const float channels[4] = { static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b), static_cast<float>(color.a) };
+                    targets.colors.add(slot->second, channels);
+                    break;
+                }
+                case ofxPresetsParameterType::Vec2:
+                    decodeVector(value, slot->second, targets.vec2s);
+                    break;
+                case ofxPresetsParameterType::Vec3:
+                    decodeVector(value, slot->second, targets.vec3s);
+                    break;
+                case ofxPresetsParameterType::Vec4:
+                    decodeVector(value, slot->second, targets.vec4s);
+                    break;
+                case ofxPresetsParameterType::FloatColor:
+                    decodeVector(value, slot->second, targets.floatColors);
+                    break;
+                case ofxPresetsParameterType::Rectangle:
+                    decodeVector(value, slot->second, targets.rectangles);
+                    break;
+                case ofxPresetsParameterType::Quat:
+                    decodeVector(value, slot->second, targets.quats);
+                    break;
+                }
+            }
+            catch (const std::exception& e) {
+                ofLogError("ofxPresets::decodeJson") << "Error reading value for key " << key << ": " << e.what();
+            }
+        }
+    }
+}
+
+
+/// <summary>
+/// Build the json of decoded preset values, same structure as saveParametersToJson
+/// </summary>
+ofJson ofxPresets::encodeJson(const ofxPresetsTargetSet& targets) {
+    ofJson j;
+    for (const auto& bindingGroup : bindingGroups) {
+        j[bindingGroup.name] = ofJson();
+    }
+
+    for (size_t i = 0; i < targets.bools.size(); ++i) {
+        const auto& binding = bindings[targets.bools.slots[i]];
+        j[binding.group][binding.key] = targets.bools.values[i] != 0;
+    }
+    for (size_t i = 0; i < targets.ints.size(); ++i) {
+        const auto& binding = bindings[targets.ints.slots[i]];
+        j[binding.group][binding.key] = targets.ints.values[i];
+    }
+    for (size_t i = 0; i < targets.floats.size(); ++i) {
+        const auto& binding = bindings[targets.floats.slots[i]];
+        j[binding.group][binding.key] = targets.floats.values[i];
+    }
+    for (size_t i = 0; i < targets.doubles.size(); ++i) {
+        const auto& binding = bindings[targets.doubles.slots[i]];
+        j[binding.group][binding.key] = targets.doubles.values[i];
+    }
+    for (size_t i = 0; i < targets.colors.size(); ++i) {
+        const auto& binding = bindings[targets.colors.slots[i]];
+        const float* c = &targets.colors.values[i * 4];
+        ofColor color(c[0], c[1], c[2], c[3]);
+        j[binding.group][binding.key] = color.getHex();
+        j[binding.group][binding.key + "_alpha"] = color.a;
+    }
+    encodeVectors(j, targets.vec2s);
+    encodeVectors(j, targets.vec3s);
+    encodeVectors(j, targets.vec4s);
+    encodeVectors(j, targets.floatColors);
+    encodeVectors(j, targets.rectangles);
+    encodeVectors(j, targets.quats);
+    return j;
+}
+
+
+/// <summary>
+/// Read a multi-component value from a json array with one number per channel
+/// </summary>
+void ofxPresets::decodeVector(const ofJson& value, size_t slot, ofxPresetsTargetSet::Lane<float>& lane) {
+    if (!value.is_array() || value.size() != lane.channels) {
+        ofLogError("ofxPresets::decodeVector") << "Expected an array of " << lane.channels << " numbers for " << bindings[slot].key;
+        return;
+    }
+    float channels[4];
+    for (size_t c = 0; c < lane.channels; ++c) {
+        channels[c] = value[c].get<float>();
+    }
+    lane.add(slot, channels);
+}
+
+
+/// <summary>
+/// Write the multi-component values of a lane as json arrays
+/// </summary>
+void ofxPresets::encodeVectors(ofJson& j, const ofxPresetsTargetSet::Lane<float>& lane) {
+    for (size_t i = 0; i < lane.size(); ++i) {
+        const auto& binding = bindings[lane.slots[i]];
+        ofJson channels = ofJson::array();
+        for (size_t c = 0; c < lane.channels; ++c) {
+            channels.push_back(lane.values[i * lane.channels + c]);
+        }
+        j[binding.group][binding.key] = channels;
+    }
+}
+
+
+/// <summary>
+/// Take the current value of a multi-component parameter
+/// </summary>
+template<typename T>
+void ofxPresets::captureVector(size_t slot, ofxPresetsTargetSet::Lane<float>& lane) {
+    float channels[4];
+    ofxPresetsVectorType<T>::write(bindings[slot].as<T>().get(), channels);
+    lane.add(slot, channels);
+}
+
+
+/// <summary>
+/// Take the current values of all parameters
+/// </summary>
+void ofxPresets::captureTargets(ofxPresetsTargetSet& targets) {
+    targets.clear();
+
+    for (size_t slot = 0; slot < bindings.size(); ++slot) {
+        const auto& binding = bindings[slot];
+
+        switch (binding.type) {
+        case ofxPresetsParameterType::Bool: {
+            uint8_t b = binding.as<bool>().get() ? 1 : 0;
+            targets.bools.add(slot, &b);
+            break;
+        }
+        case ofxPresetsParameterType::Int: {
+            int64_t i = binding.as<int>().get();
+            targets.ints.add(slot, &i);
+            break;
+        }
+        case ofxPresetsParameterType::Float: {
+            float f = binding.as<float>().get();
+            targets.floats.add(slot, &f);
+            break;
+        }
+        case ofxPresetsParameterType::Double: {
+            double d = binding.as<double>().get();
+            targets.doubles.add(slot, &d);
+            break;
+        }
+        case ofxPresetsParameterType::Color: {
+            const ofColor& color = binding.as<ofColor>().get();
+            const float channels[4] = { static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b), static_cast<float>(color.a) };
+            targets.colors.add(slot, channels);
+            break;
+        }
+        case ofxPresetsParameterType::Vec2:
+            captureVector<glm::vec2>(slot, targets.vec2s);
+            break;
+        case ofxPresetsParameterType::Vec3:
+            captureVector<glm::vec3>(slot, targets.vec3s);
+            break;
+        case ofxPresetsParameterType::Vec4:
+            captureVector<glm::vec4>(slot, targets.vec4s);
+            break;
+        case ofxPresetsParameterType::FloatColor:
+            captureVector<ofFloatColor>(slot, targets.floatColors);
+            break;
+        case ofxPresetsParameterType::Rectangle:
+            captureVector<ofRectangle>(slot, targets.rectangles);
+            break;
+        case ofxPresetsParameterType::Quat:
+            captureVector<glm::quat>(slot, targets.quats);
+            break;
+        }
+    }
+}
+
+
+/// <summary>
+/// Start a transition towards decoded preset values. Bools are set right away
+/// </summary>
+/// <param name="duration">of the transition, in seconds</param>
+void ofxPresets::applyTargets(const ofxPresetsTargetSet& targets, float duration) {
+    dropPendingInterpolation();
+    OFX_PRESETS_STATS_DO(stats.addPresetApplied());
+    interpolator.begin(currentTime);
+
+    transitionDuration = duration;
+
+    applyBoolValues(targets.bools.slots, targets.bools.values.data());
+    interpolator.add(targets);
+
+	storeCurrentValues(); // needed for interpolation
+}
+
+
+
+/// <summary>
+/// Save the current values of the targeted parameters to use them as a reference for interpolation.
+/// Only the slots of the new targets are read. The ones an interrupted transition was moving
+/// start from its in-flight values, so retargeting several times per second does not step.
+/// Floats, doubles, colors and the multi-component types keep their unrounded values, ints are already whole numbers in their lane
+/// </summary>
+void ofxPresets::storeCurrentValues() {
+    OFX_PRESETS_STATS_TIME(stats, StoreValues);
+    auto& ints = interpolator.ints;
+    for (size_t i = 0; i < ints.size(); ++i) {
+        if (!interpolator.startFromInFlight(ints, i)) {
+            ints.start[i] = bindings[ints.slots[i]].as<int>().get();
+        }
+    }
+
+    auto& floats = interpolator.floats;
+    for (size_t i = 0; i < floats.size(); ++i) {
+        if (!interpolator.startFromInFlight(floats, i)) {
+            floats.start[i] = bindings[floats.slots[i]].as<float>().get();
+        }
+    }
+
+    auto& doubles = interpolator.doubles;
+    for (size_t i = 0; i < doubles.size(); ++i) {
+        if (!interpolator.startFromInFlight(doubles, i)) {
+            doubles.start[i] = bindings[doubles.slots[i]].as<double>().get();
+        }
+    }
+
+    auto& colors = interpolator.colors;
+    for (size_t i = 0; i < colors.size(); ++i) {
+        if (interpolator.startFromInFlight(colors, i)) {
+            continue;
+        }
+        const ofColor& color = bindings[colors.slots[i]].as<ofColor>().get();
+        for (size_t c = 0; c < 4; ++c) {
+            colors.start[i * 4 + c] = color[c];
+        }
+    }
+
+    storeVectorValues<glm::vec2>(interpolator.vec2s);
+    storeVectorValues<glm::vec3>(interpolator.vec3s);
+    storeVectorValues<glm::vec4>(interpolator.vec4s);
+    storeVectorValues<ofFloatColor>(interpolator.floatColors);
+    storeVectorValues<ofRectangle>(interpolator.rectangles);
+    storeVectorValues<glm::quat>(interpolator.quats);
+    interpolator.colorsChanged();
+}
+
+
+/// <summary>
+/// Start values of a multi-component lane
+/// </summary>
+template<typename T>
+void ofxPresets::storeVectorValues(ofxPresetsInterpolator::Lane<float>& lane) {
+    for (size_t i = 0; i < lane.size(); ++i) {
+        if (!interpolator.startFromInFlight(lane, i)) {
+            ofxPresetsVectorType<T>::write(bindings[lane.slots[i]].as<T>().get(), &lane.start[i * lane.channels]);
+        }
+    }
+}
+
+
+
+
+/// <summary>
+/// Mutate the parameters with a random value within the min and max range
+/// Uses the global mutationPercentage (Default 0.1)
+/// </summary>
+void ofxPresets::mutate(){
+	mutate(mutationPercentage);
+}
+
+
+/// <summary>
+/// Mutate the parameters with a random value within the min and max range
+/// </summary>
+/// <param name="percentage">This will modify the public mutationPercentage</param>
+void ofxPresets::mutate(float percentage) {
+	ofLog(OF_LOG_VERBOSE) << "ofxPresets::mutate:: Mutating current parameter values with percentage " << percentage;
+
+	mutationPercentage.set(percentage);
+
+    dropPendingInterpolation();
+    interpolator.begin(currentTime); // Clear any existing interpolation data
+    transitionDuration = interpolationDuration.get();
+
+    // the current values are the targets to mutate, bools and the multi-component types are not mutated
+    for (size_t slot = 0; slot < bindings.size(); ++slot) {
+        auto& binding = bindings[slot];
+        switch (binding.type) {
+        case ofxPresetsParameterType::Int:
+            interpolator.addInt(slot, binding.as<int>().get());
+            break;
+        case ofxPresetsParameterType::Float:
+            interpolator.addFloat(slot, binding.as<float>().get());
+            break;
+        case ofxPresetsParameterType::Double:
+            interpolator.addDouble(slot, binding.as<double>().get());
+            break;
+        case ofxPresetsParameterType::Color: {
+            const ofColor& color = binding.as<ofColor>().get();
+            interpolator.addColor(slot, color.r, color.g, color.b, color.a);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    mutateTargets(interpolator, percentage, random);
+
+    storeCurrentValues(); // Store current values as a reference
+	// No need to start the interpolation, it will be done on the next update, since the interpolator is active
+}
+
+
+/// <summary>
+/// Take an existent preset and mutate the values
+/// </summary>
+/// <param name="id"></param>
+/// <param name="percentage"></param>
+void ofxPresets::mutateFromPreset(int id, float percentage) {
+    mutateFromPreset(id, percentage, interpolationDuration.get(), random);
+}
+
+
+/// <summary>
+/// Take an existent preset and mutate the values, with the duration and the random values of a sequence step
+/// </summary>
+void ofxPresets::mutateFromPreset(int id, float percentage, float duration, ofxPresetsRandom& generator) {
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::mutateFromPreset:: About to mutate values from the preset " << -id;
+
+    // Apply the preset without interpolation
+    if (!applyPresetValues(-id, duration)) {
+        ofLogError("ofxPresets::mutateFromPreset") << "Preset file does not exist for ID: " << id;
+        return;
+    }
+
+    // Store current values as a reference
+    storeCurrentValues();
+
+    // Mutate the parameters with the given percentage
+    mutationPercentage.set(percentage);
+
+    mutateTargets(interpolator, percentage, generator);
+}
+
+
+/// <summary>
+/// Mutate the target values of a transition, the running one or one being baked.
+/// The targets are the current values for mutate(), the values of the preset for mutateFromPreset() and the sequence steps
+/// </summary>
+/// <param name="percentage"></param>
+/// <param name="generator">the manager generator, or the one of a sequence step</param>
+void ofxPresets::mutateTargets(ofxPresetsInterpolator& lanes, float percentage, ofxPresetsRandom& generator) {
+    // all the random values at once: one per number, four per color
+    mutationNoise.resize(lanes.ints.size() + lanes.floats.size() + lanes.doubles.size() + lanes.colors.size() * 4);
+    generator.normals(mutationNoise.data(), mutationNoise.size(), percentage / 4);
+    const float* noise = mutationNoise.data();
+
+    mutateNumbers<int>(lanes.ints, noise);
+    mutateNumbers<float>(lanes.floats, noise);
+    mutateNumbers<double>(lanes.doubles, noise);
+
+    // Special case for colors, mutate the hue, brightness and saturation
+    auto& colors = lanes.colors;
+    for (size_t i = 0; i < colors.size(); ++i) {
+        if (lanes.colorSpace == ofxPresetsColorSpace::OKLab) {
+            mutateColor(&colors.target[i * 4], noise);
+            noise += 4;
+            continue;
+        }
+        ofColor targetColor(colors.target[i * 4], colors.target[i * 4 + 1], colors.target[i * 4 + 2], colors.target[i * 4 + 3]);
+        float range = 255.0f;
+
+        // change the hue
+        float mutation = *noise++ * range;
+        float mutatedValue = std::clamp(targetColor.getHue() + mutation, 0.0f, 255.0f);
+        targetColor.setHue(mutatedValue);
+
+        // repeat for brightness
+        mutation = *noise++ * range;
+        mutatedValue = targetColor.getBrightness() + mutation;
+        mutatedValue = std::clamp(mutatedValue, 0.0f, 255.0f);
+        targetColor.setBrightness(mutatedValue);
+
+        // repeat for saturation
+        mutation = *noise++ * range;
+        mutatedValue = targetColor.getSaturation() + mutation;
+        mutatedValue = std::clamp(mutatedValue, 0.0f, 255.0f);
+        targetColor.setSaturation(mutatedValue);
+
+        // alpha value
+        targetColor.a = std::clamp(targetColor.a + *noise++ * 255.0f, 0.0f, 255.0f);
+
+        for (size_t c = 0; c < 4; ++c) {
+            colors.target[i * 4 + c] = targetColor[c];
+        }
+    }
+    lanes.colorsChanged();
+}
+
+
+/// <summary>
+/// Add a mutation to the targets of a lane of numbers, within the range of their parameters
+/// </summary>
+/// <typeparam name="T">type of the parameters</typeparam>
+/// <param name="noise">one normal value per slot, already scaled by the deviation of the mutation. Moved past them</param>
+template<typename T, typename Value>
+void ofxPresets::mutateNumbers(ofxPresetsInterpolator::Lane<Value>& lane, const float*& noise) {
+    for (size_t i = 0; i < lane.size(); ++i) {
+        const size_t slot = lane.slots[i];
+        auto& param = bindings[slot].as<T>();
+        double minValue = param.getMin();  // in double, so large ints and doubles keep their precision
+        double maxValue = param.getMax();
+        double mutatedValue = std::clamp(lane.target[i] + *noise++ * (maxValue - minValue), minValue, maxValue);
+        if constexpr (std::is_integral_v<Value>) {
+            lane.target[i] = std::llround(mutatedValue);
+        }
+        else {
+            lane.target[i] = static_cast<Value>(mutatedValue);
+        }
+    }
+}
+
+
+/// <summary>
+/// Mutate one color in OKLCh (lightness, chroma and hue), used with the OKLab color space
+/// </summary>
+/// <param name="rgba">channels from 0 to 255, changed in place</param>
+/// <param name="noise">four normal values, already scaled by the deviation of the mutation</param>
+void ofxPresets::mutateColor(float* rgba, const float* noise) {
+    ofxPresetsColor::shift(rgba, 255.0f, noise[0], noise[1], noise[2]);
+    rgba[3] = std::clamp(rgba[3] + noise[3] * 255.0f, 0.0f, 255.0f);
+}
+
+
+/// <summary>
+/// Restart the generator of the random presets and mutations, the same seed plays the same random steps
+/// and mutations again. Each manager has its own generator, seeded differently on construction
+/// </summary>
+void ofxPresets::setSeed(uint64_t seed) {
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::setSeed:: Seeding the random presets and mutations with " << seed;
+    random.seed(seed);
+}
+
+
+
+#pragma endregion
+
+
+
+
+
+
+
+
+/// <summary>
+/// Set the parameters to a weighted mix of presets, i.e. setBlend({ {1, 0.5f}, {4, 0.3f}, {7, 0.2f} })
+/// The presets are read and resolved to slots on the first call, calls with the same ids in the same order
+/// only change the weights: one pass over the cached values, no file access, so it can follow a slider or a fader every frame.
+/// Numbers, vectors and colors (in the color space set with setColorSpace) are mixed, bools take the values of the preset
+/// with the largest weight. Parameters none of the presets has are left as they are.
+/// A running transition is stopped, a playing sequence goes on with its next step
+/// </summary>
+/// <param name="weights">preset id and weight pairs, the weights are normalized to add up to 1</param>
+/// <returns>false if a preset does not exist or the weights do not add up to more than 0</returns>
+bool ofxPresets::setBlend(const std::vector<std::pair<int, float>>& weights) {
+    float total = 0.0f;
+    for (auto& [id, weight] : weights) {
+        total += weight;
+    }
+    if (weights.empty() || !(total > 0.0f)) {
+        ofLogError("ofxPresets::setBlend") << "The weights of the presets must add up to more than 0";
+        return false;
+    }
+
+    bool sameIds = blend.valid && blend.count() == weights.size();
+    for (size_t i = 0; sameIds && i < weights.size(); ++i) {
+        sameIds = blend.ids[i] == weights[i].first;
+    }
+    if (!sameIds) {
+        std::vector<int> ids;
+        for (auto& [id, weight] : weights) {
+            ids.push_back(id);
+        }
+        if (!buildBlend(ids)) {
+            return false;
+        }
+    }
+
+    blendWeights.resize(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+        blendWeights[i] = weights[i].second / total;
+    }
+
+    dropPendingInterpolation();
+    interpolator.clear();
+
+    {
+        OFX_PRESETS_STATS_TIME(stats, Interpolate);
+        blend.evaluate(blendWeights.data());
+    }
+
+    applyBoolValues(blend.sources.bools.slots, blend.dominantBools(blendWeights.data()));
+    applyLaneValues(blend.output);
+    return true;
+}
+
+
+/// <summary>
+/// Release the presets cached by setBlend
+/// </summary>
+void ofxPresets::clearBlend() {
+    blend = ofxPresetsBlend();
+    blendWeights.clear();
+}
+
+
+/// <summary>
+/// Read the presets of a blend, from the bank when enabled, and resolve them to the same slots.
+/// Slots only some of the presets have take the current values of the parameters for the others
+/// </summary>
+bool ofxPresets::buildBlend(const std::vector<int>& ids) {
+    blend.invalidate();
+
+    std::vector<ofxPresetsTargetSet> presets(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (!fetchPreset(ids[i], presets[i])) {
+            ofLogError("ofxPresets::setBlend") << "No preset " << ids[i] << " to blend";
+            return false;
+        }
+    }
+
+    ofxPresetsTargetSet current;
+    captureTargets(current);
+    blend.build(ids, presets, current, bindings.size(), interpolator.colorSpace);
+
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::buildBlend:: " << ids.size() << " presets, " << blend.output.floats.size() << " floats";
+    return true;
+}
+
+
+/// <summary>
+/// Decoded values of a preset, copied from the bank when enabled or read from its file
+/// </summary>
+/// <returns>false if the preset does not exist</returns>
+bool ofxPresets::fetchPreset(int id, ofxPresetsTargetSet& targets) {
+    if (presetBankEnabled) {
+        auto entry = presetBank.find(id);
+        if (entry == presetBank.end()) {
+            return false;
+        }
+        targets = entry->second.targets;
+        return true;
+    }
+    return presetExist(id) && readPreset(id, targets);
+}
+
+
+/// <summary>
+/// Drop the cached blend when one of its presets changed, it is built again on the next setBlend
+/// </summary>
+void ofxPresets::invalidateBlend(int id) {
+    if (blend.uses(id)) {
+        blend.invalidate();
+    }
+}
+
+
+
+/// <summary>
+/// Apply a preset to the parameters
+/// Uses the global interpolation duration
+/// </summary>
+/// <param name="id"></param>
+void ofxPresets::applyPreset(int id) {
+	applyPreset(id, interpolationDuration);
+}
+
+/// <summary>
+/// Apply a preset to the parameters
+/// </summary>
+/// <param name="id"></param>
+/// <param name="parameterGroups"></param>
+/// <param name="duration">This will update the global interpolationDuration</param>
+void ofxPresets::applyPreset(int id, float duration) {
+    interpolationDuration.set(duration);
+    startPreset(id, duration, random);
+}
+
+
+/// <summary>
+/// Start the transition to a preset, a random one or a mutation, without changing interpolationDuration
+/// </summary>
+/// <param name="generator">for random presets and mutations: the manager generator, or the one of a sequence step</param>
+void ofxPresets::startPreset(int id, float duration, ofxPresetsRandom& generator) {
+
+    // mutation
+    if (id < 0) {
+        mutateFromPreset(id, mutationPercentage, duration, generator);
+        lastAppliedPreset = id;
+		presetAppicationStarted.notify();
+        return;
+    }
+
+    // random preset
+    if (id == 0) {
+        id = getRandomPreset(1, MAX_RANDOM_PRESET, generator);
+	}
+
+	// apply preset
+    if (applyPresetValues(id, duration)) {
+        lastAppliedPreset = id;
+        presetAppicationStarted.notify();
+    }
+    else {
+        ofLog(OF_LOG_WARNING) << "ofxPresets::applyPreset:: No preset file for preset " << id << " : " << convertIDtoJSonFilename(id);
+    }
+}
+
+
+/// <summary>
+/// Start the transition to the values of a preset, taken from the bank when enabled or read from its file
+/// </summary>
+/// <returns>false if the preset does not exist</returns>
+bool ofxPresets::applyPresetValues(int id, float duration) {
+    if (presetBankEnabled) {
+        auto entry = presetBank.find(id);
+        if (entry == presetBank.end()) {
+            return false;
+        }
+        applyTargets(entry->second.targets, duration);
+        return true;
+    }
+
+    if (!presetExist(id)) {
+        return false;
+    }
+
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::applyPresetValues:: Applying preset to parameters from "
+        << (archive.isOpen() ? archive.getPath() + " #" + std::to_string(id) : presetFilePath(id));
+
+    ofxPresetsTargetSet targets;
+    if (!readPreset(id, targets)) {
+        return false;
+    }
+
+    applyTargets(targets, duration);
+    return true;
+}
+
+/// <summary>
+/// Pick a random preset among the existing ones, using the preset index
+/// </summary>
+/// <param name="lowerPreset">First id of the range</param>
+/// <param name="higherPreset">End of the range, not included</param>
+/// <param name="generator">the manager generator, or the one of a sequence step</param>
+/// <returns>lowerPreset when there are no presets in the range</returns>
+int ofxPresets::getRandomPreset(int lowerPreset, int higherPreset, ofxPresetsRandom& generator) {
+    if (!presetIndexBuilt) {
+        buildPresetIndex();
+    }
+
+    auto first = std::lower_bound(presetIndex.begin(), presetIndex.end(), lowerPreset);
+    auto last = std::lower_bound(first, presetIndex.end(), higherPreset);
+    size_t count = std::distance(first, last);
+
+    if (count == 0) {
+        ofLogError("ofxPresets::getRandomPreset") << "Could not find valid random preset file";
+        return lowerPreset;
+    }
+
+    size_t pick = generator.below(count);
+    int id = *(first + pick);
+
+	ofLog(OF_LOG_VERBOSE) << "ofxPresets::getRandomPreset:: Getting random preset " << id;
+    return id;
+}
+
+
+/// <summary>
+/// Returns the current preset item in the sequence
+/// Will report the actual preset when 0 (random) is found
+/// </summary>
+/// <returns></returns>
+int ofxPresets::getCurrentPreset() {
+    return lastAppliedPreset;
+}
+
+
+/// <summary>
+/// Stops the running interpolation
+/// </summary>
+void ofxPresets::stopInterpolating() {
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::stopSequence:: Stopping interpolation";
+    dropPendingInterpolation();
+    interpolator.clear();
+}
+
+/// <summary>
+/// Stops the running sequence, track and interpolation
+/// </summary>
+void ofxPresets::stop() {
+    stopInterpolating();
+    stopSequence();
+    stopTrack();
+}
+
+
+
+/// <summary>
+/// public method to save the current parameters to a preset file, json or binary depending on the preset format
+/// The values are taken right away, the file is written on a background thread, see presetSaved and waitForSaves().
+/// Until then, applying the preset reads these values, not the file
+/// </summary>
+/// <param name="id">The preset ID (1-based)</param>
+void ofxPresets::savePreset(int id) {
+    auto job = std::make_shared<ofxPresetsSaveJob>();
+    job->id = id;
+    job->binary = useBinaryFormat(presetFormat);
+    job->compactJson = compactJson;
+    job->toArchive = archive.isOpen();
+    if (!job->toArchive) {
+        job->filePath = job->binary ? convertIDtoBinaryFilename(id) : convertIDtoJSonFilename(id);
+        job->otherFilePath = job->binary ? convertIDtoJSonFilename(id) : convertIDtoBinaryFilename(id);
+    }
+    captureTargets(job->targets);
+
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::savePreset:: Saving preset " << id << " to " << (job->toArchive ? archive.getPath() : job->filePath);
+
+    addToPresetIndex(id, job->binary && !job->toArchive);
+    if (presetBankEnabled) {
+        presetBank[id].targets = job->targets;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(savingPresetsMutex);
+        savingPresets[id] = job;
+    }
+    pendingSaves++;
+    saveWorker.post([this, job]() { writeSaveJob(*job); });
+}
+
+
+
+#pragma region FileHandling
+
+
+/// <summary>
+/// Given an integer ID, convert it to a file path string
+/// </summary>
+/// <param name="id"></param>
+/// <returns>filename is two digits. ie. 1 -> data\01.json </returns>
+std::string ofxPresets::convertIDtoJSonFilename(int id) {
+    std::string idStr = (id < 10 ? "0" : "") + std::to_string(id);
+    std::string jsonFilePath = folderPath + idStr + ".json";
+    return jsonFilePath;
+}
+
+
+/// <summary>
+/// Given an integer ID, convert it to a binary file path string
+/// </summary>
+/// <param name="id"></param>
+/// <returns>filename is two digits. ie. 1 -> data\01.bin </returns>
+std::string ofxPresets::convertIDtoBinaryFilename(int id) {
+    std::string idStr = (id < 10 ? "0" : "") + std::to_string(id);
+    return folderPath + idStr + ".bin";
+}
+
+
+/// <summary>
+/// Given a file name, get the preset ID it belongs to
+/// </summary>
+/// <param name="filename">file name without the folder. ie. 01.json -> 1, 01.bin -> 1 </param>
+/// <param name="binary">set to true for binary files</param>
+/// <returns>0 if it is not a preset file name</returns>
+int ofxPresets::convertFilenameToID(const std::string& filename, bool& binary) {
+    auto hasExtension = [&filename](const std::string& extension) {
+        return filename.size() > extension.size() && filename.size() <= extension.size() + 9 &&
+            filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    binary = hasExtension(".bin");
+    if (!binary && !hasExtension(".json")) {
+        return 0;
+    }
+    const std::string extension = binary ? ".bin" : ".json";
+
+    std::string idStr = filename.substr(0, filename.size() - extension.size());
+    if (!std::all_of(idStr.begin(), idStr.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        return 0;
+    }
+
+    // only the exact names produced by convertIDtoJSonFilename, i.e. not 1.json or 001.json
+    int id = std::stoi(idStr);
+    std::string expected = binary ? convertIDtoBinaryFilename(id) : convertIDtoJSonFilename(id);
+    if (id <= 0 || expected != folderPath + filename) {
+        return 0;
+    }
+    return id;
+}
+
+
+/// <summary>
+/// Path of the file a preset is stored in, the binary one when both exist
+/// </summary>
+std::string ofxPresets::presetFilePath(int id) {
+    if (!presetIndexBuilt) {
+        buildPresetIndex();
+    }
+    if (std::binary_search(binaryPresetIndex.begin(), binaryPresetIndex.end(), id)) {
+        return convertIDtoBinaryFilename(id);
+    }
+    return convertIDtoJSonFilename(id);
+}
+
+
+bool ofxPresets::isBinaryFilePath(const std::string& filePath) const {
+    return std::filesystem::path(filePath).extension() == ".bin";
+}
+
+
+/// <summary
+/// Check if a file exists
+/// </summary>
+bool ofxPresets::fileExist(const std::string& jsonFilePath) {
+    std::ifstream file(jsonFilePath);
+    if (!file.is_open()) {
+        return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Sets the relative path to the folder where the presets will be saved and loaded
+/// </summary>
+/// <param name="path">example: "data\\presets\\"</param>
+void ofxPresets::setFolderPath(const std::string& path) {
+    cancelPrefetch();
+    prefetchWorker.wait(); // the worker reads the folder path
+    flushSaves();
+
+    folderPath = path;
+	
+    if (!std::filesystem::exists(folderPath)) {
+		ofLog(OF_LOG_NOTICE) << "ofxPresets::setFolderPath:: Creating folder " << folderPath;
+		std::filesystem::create_directory(folderPath);
+	}
+
+    buildPresetIndex();
+
+    if (presetBankEnabled) {
+        presetBank.clear();
+        refreshPresetBank();
+    }
+}
+
+
+/// <summary>
+/// Verify if an associated json file exists for a given preset ID
+/// Uses the preset index, no file is opened
+/// </summary>
+/// <param name="id"></param>
+/// <returns></returns>
+bool ofxPresets::presetExist(int id) {
+    if (presetBankEnabled) {
+        return presetBank.find(id) != presetBank.end();
+    }
+    if (!presetIndexBuilt) {
+        buildPresetIndex();
+    }
+    return std::binary_search(presetIndex.begin(), presetIndex.end(), id);
+}
+
+
+/// <summary>
+/// Sorted ids of the existing presets
+/// </summary>
+const std::vector<int>& ofxPresets::getPresetIds() {
+    if (!presetIndexBuilt) {
+        buildPresetIndex();
+    }
+    return presetIndex;
+}
+
+
+/// <summary>
+/// Scan the preset folder again, for when preset files were added or removed outside the manager
+/// </summary>
+void ofxPresets::refreshPresetIndex() {
+    buildPresetIndex();
+}
+
+
+/// <summary>
+/// Build the preset index with a single scan of the preset folder
+/// </summary>
+void ofxPresets::buildPresetIndex() {
+    flushSaves(); // saved presets are indexed before their file exists
+
+    presetIndex.clear();
+    binaryPresetIndex.clear();
+    blend.invalidate();
+
+    if (archive.isOpen()) {
+        presetIndex = archive.ids();
+        presetIndexBuilt = true;
+        return;
+    }
+
+    std::error_code error;
+    for (auto& entry : std::filesystem::directory_iterator(folderPath, error)) {
+        bool binary = false;
+        int id = convertFilenameToID(entry.path().filename().string(), binary);
+        if (id > 0) {
+            presetIndex.push_back(id);
+            if (binary) {
+                binaryPresetIndex.push_back(id);
+            }
+        }
+    }
+    std::sort(presetIndex.begin(), presetIndex.end());
+    presetIndex.erase(std::unique(presetIndex.begin(), presetIndex.end()), presetIndex.end()); // saved in both formats
+    std::sort(binaryPresetIndex.begin(), binaryPresetIndex.end());
+    presetIndexBuilt = true;
+
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::buildPresetIndex:: " << presetIndex.size() << " presets found in " << folderPath;
+}
+
+
+void ofxPresets::addToPresetIndex(int id, bool binary) {
+    invalidateBlend(id); // saved, cloned to or converted
+    auto it = std::lower_bound(presetIndex.begin(), presetIndex.end(), id);
+    if (it == presetIndex.end() || *it != id) {
+        presetIndex.insert(it, id);
+    }
+
+    auto binaryIt = std::lower_bound(binaryPresetIndex.begin(), binaryPresetIndex.end(), id);
+    bool indexed = binaryIt != binaryPresetIndex.end() && *binaryIt == id;
+    if (binary && !indexed) {
+        binaryPresetIndex.insert(binaryIt, id);
+    }
+    else if (!binary && indexed) {
+        binaryPresetIndex.erase(binaryIt);
+    }
+}
+
+
+void ofxPresets::removeFromPresetIndex(int id) {
+    invalidateBlend(id);
+    auto it = std::lower_bound(presetIndex.begin(), presetIndex.end(), id);
+    if (it != presetIndex.end() && *it == id) {
+        presetIndex.erase(it);
+    }
+
+    auto binaryIt = std::lower_bound(binaryPresetIndex.begin(), binaryPresetIndex.end(), id);
+    if (binaryIt != binaryPresetIndex.end() && *binaryIt == id) {
+        binaryPresetIndex.erase(binaryIt);
+    }
+}
+
+
+
+/// <summary>
+/// Delete a preset file
+/// </summary>
+/// <param name="id"></param>
+void ofxPresets::deletePreset(int id) {
+    flushSaves();
+    if (archive.isOpen()) {
+        if (archive.remove(id)) {
+            ofLog(OF_LOG_VERBOSE) << "ofxPresets::deletePreset" << "Preset " << id << " deleted";
+        }
+        if (archive.needsCompaction()) {
+            compactArchive();
+        }
+    }
+    else {
+        for (auto& filePath : { convertIDtoJSonFilename(id), convertIDtoBinaryFilename(id) }) {
+            if (fileExist(filePath)) {
+                std::remove(filePath.c_str());
+                ofLog(OF_LOG_VERBOSE) << "ofxPresets::deletePreset" << "Preset " << id << " deleted";
+            }
+        }
+    }
+    removeFromPresetIndex(id);
+    presetBank.erase(id);
+}
+
+
+
+
+/// <summary>
+/// Clone a preset to another preset
+/// </summary>
+void ofxPresets::clonePresetTo(int from, int to) {
+    flushSaves();
+    if (archive.isOpen()) {
+        std::vector<uint8_t> bytes;
+        uint32_t format;
+        if (!archive.read(from, bytes, format)) {
+            ofLog(OF_LOG_ERROR) << "ofxPresets::clonePresetTo:: No source preset " << from << " in " << archive.getPath();
+            return;
+        }
+        ofLog(OF_LOG_VERBOSE) << "ofxPresets::clonePresetTo:: Cloning preset " << from << " to " << to;
+        if (archive.put(to, format, bytes.data(), bytes.size())) {
+            addToPresetIndex(to, false);
+            if (presetBankEnabled) {
+                loadBankEntry(to);
+            }
+        }
+        return;
+    }
+
+    std::string fromFilePath = presetFilePath(from);
+    bool binary = isBinaryFilePath(fromFilePath);
+    std::string toFilePath = binary ? convertIDtoBinaryFilename(to) : convertIDtoJSonFilename(to);
+
+    if (fileExist(fromFilePath)) {
+        ofLog(OF_LOG_VERBOSE) << "ofxPresets::clonePresetTo:: Cloning preset " << from << " to " << to;
+        std::ifstream src(fromFilePath, std::ios::binary);
+        std::ofstream dst(toFilePath, std::ios::binary);
+        dst << src.rdbuf();
+        dst.close();
+
+        std::error_code error;
+        std::filesystem::remove(binary ? convertIDtoJSonFilename(to) : convertIDtoBinaryFilename(to), error);
+        addToPresetIndex(to, binary);
+
+        if (presetBankEnabled) {
+            loadBankEntry(to);
+        }
+    }
+    else {
+        ofLog(OF_LOG_ERROR) << "ofxPresets::clonePresetTo:: No preset file for source preset " << from << ". Looking for " << fromFilePath;
+    }
+}
+
+
+
+#pragma endregion
+
+
+
+#pragma region Archive
+
+
+/// <summary>
+/// Store the presets in a single archive file instead of one file per preset.
+/// While open, saving, applying, deleting and cloning presets use the archive, the preset folder is not read
+/// </summary>
+/// <param name="archivePath">i.e. "data\\presets.ofxpa", created if it does not exist</param>
+/// <returns>false if the file is not a valid archive</returns>
+bool ofxPresets::openArchive(const std::string& archivePath) {
+    cancelPrefetch();
+    prefetchWorker.wait(); // the workers may be reading or writing presets
+    flushSaves();
+
+    std::string error;
+    bool opened = archive.open(archivePath, error);
+    if (opened) {
+        ofLog(OF_LOG_NOTICE) << "ofxPresets::openArchive:: Using archive " << archivePath;
+    }
+    else {
+        ofLogError("ofxPresets::openArchive") << "Could not open archive " << archivePath << ": " << error;
+    }
+
+    buildPresetIndex();
+    if (presetBankEnabled) {
+        presetBank.clear();
+        refreshPresetBank();
+    }
+    return opened;
+}
+
+
+/// <summary>
+/// Go back to the preset folder
+/// </summary>
+void ofxPresets::closeArchive() {
+    cancelPrefetch();
+    prefetchWorker.wait();
+    flushSaves();
+
+    archive.close();
+
+    buildPresetIndex();
+    if (presetBankEnabled) {
+        presetBank.clear();
+        refreshPresetBank();
+    }
+}
+
+
+/// <summary>
+/// Copy the preset files of the preset folder into the open archive, replacing the presets with the same id
+/// </summary>
+void ofxPresets::importPresetsToArchive() {
+    if (!archive.isOpen()) {
+        ofLogError("ofxPresets::importPresetsToArchive") << "No archive open";
+        return;
+    }
+    flushSaves();
+
+    std::map<int, ofxPresetsArchive::Payload> payloads;
+    std::error_code error;
+    for (auto& entry : std::filesystem::directory_iterator(folderPath, error)) {
+        bool binary = false;
+        int id = convertFilenameToID(entry.path().filename().string(), binary);
+        if (id <= 0) {
+            continue;
+        }
+
+        // the binary file wins when both exist, as when reading from the folder
+        auto existing = payloads.find(id);
+        if (existing != payloads.end() && existing->second.format == ofxPresetsArchive::Binary) {
+            continue;
+        }
+
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        payloads.insert_or_assign(id, ofxPresetsArchive::Payload{ id, binary ? ofxPresetsArchive::Binary : ofxPresetsArchive::Json, std::move(bytes) });
+    }
+
+    std::vector<ofxPresetsArchive::Payload> batch;
+    for (auto& [id, payload] : payloads) {
+        batch.push_back(std::move(payload));
+    }
+    if (!archive.put(batch)) {
+        ofLogError("ofxPresets::importPresetsToArchive") << "Could not write to " << archive.getPath();
+        return;
+    }
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::importPresetsToArchive:: " << batch.size() << " presets imported from " << folderPath;
+
+    buildPresetIndex();
+    refreshPresetBank();
 }
 
 
+/// <summary>
+/// Write every preset of the open archive as a preset file (NN.json or NN.bin) in the preset folder
+/// </summary>
+void ofxPresets::exportArchiveToFolder() {
+    if (!archive.isOpen()) {
+        ofLogError("ofxPresets::exportArchiveToFolder") << "No archive open";
+        return;
+    }
+    flushSaves();
+
+    if (!std::filesystem::exists(folderPath)) {
+        std::filesystem::create_directory(folderPath);
+    }
+
+    for (int id : archive.ids()) {
+        std::vector<uint8_t> bytes;
+        uint32_t format;
+        if (!archive.read(id, bytes, format)) {
+            continue;
+        }
+
+        bool binary = format == ofxPresetsArchive::Binary;
+        std::string filePath = binary ? convertIDtoBinaryFilename(id) : convertIDtoJSonFilename(id);
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (!file) {
+            ofLogError("ofxPresets::exportArchiveToFolder") << "Could not write " << filePath;
+            continue;
+        }
+
+        std::error_code error;
+        std::filesystem::remove(binary ? convertIDtoJSonFilename(id) : convertIDtoBinaryFilename(id), error);
+    }
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::exportArchiveToFolder:: Presets exported to " << folderPath;
+}
+
 
 /// <summary>
-/// public method to save the current parameters to a json file
+/// Drop the replaced payloads from the archive file.
+/// Also happens on its own after saving or deleting, once the dead space is larger than the presets
 /// </summary>
-/// <param name="id">The preset ID (1-based)</param>
-/// <param name="parameterGroups">all groups to be saved</param>
-void ofxPresets::savePreset(int id) {
-    std::string jsonFilePath = convertIDtoJSonFilename(id);
-    saveParametersToJson(jsonFilePath);
+void ofxPresets::compactArchive() {
+    std::string error;
+    if (!archive.compact(error)) {
+        ofLogError("ofxPresets::compactArchive") << "Could not compact " << archive.getPath() << ": " << error;
+        return;
+    }
+
+    // payloads moved, the bank entries are still the same presets
+    for (auto& [id, entry] : presetBank) {
+        ofxPresetsArchive::Entry archived;
+        if (archive.find(id, archived)) {
+            entry.archiveOffset = archived.offset;
+        }
+    }
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::compactArchive:: " << archive.getPath() << " compacted";
+}
+
+
+/// <summary>
+/// Decode a preset from the mapped archive. Binary payloads are decoded in place
+/// </summary>
+bool ofxPresets::readArchivePreset(int id, ofxPresetsTargetSet& targets) {
+    std::string error;
+    std::string jsonText;
+    bool isJson = false;
+
+    OFX_PRESETS_STATS_TIME(stats, Parse); // the payload is already mapped
+    bool read = archive.visit(id, [&](const uint8_t* data, size_t size, uint32_t format) {
+        OFX_PRESETS_STATS_DO(stats.addBytesRead(size));
+        if (format == ofxPresetsArchive::Binary) {
+            return ofxPresetsBinary::decode(data, size, schemaHash, bindingLanes, targets, error);
+        }
+        jsonText.assign(reinterpret_cast<const char*>(data), size);
+        isJson = true;
+        return true;
+    });
+
+    if (read && isJson) {
+        try {
+            ofJson j = ofJson::parse(jsonText);
+            decodeJson(j, targets);
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+            read = false;
+        }
+    }
+
+    if (!read) {
+        ofLogError("ofxPresets::readArchivePreset") << "Could not read preset " << id << " from " << archive.getPath() << (error.empty() ? "" : ": " + error);
+    }
+    return read;
 }
 
 
+#pragma endregion
 
-#pragma region FileHandling
+
+
+#pragma region PresetBank
 
 
 /// <summary>
-/// Given an integer ID, convert it to a file path string
+/// Keep every preset of the folder decoded in memory.
+/// While enabled, applying a preset does not touch the disk nor parse json
 /// </summary>
-/// <param name="id"></param>
-/// <returns>filename is two digits. ie. 1 -> data\01.json </returns>
-std::string ofxPresets::convertIDtoJSonFilename(int id) {
-    std::string idStr = (id < 10 ? "0" : "") + std::to_string(id);
-    std::string jsonFilePath = folderPath + idStr + ".json";
-    return jsonFilePath;
+/// <param name="enable">false drops the bank and goes back to reading the files</param>
+void ofxPresets::enablePresetBank(bool enable) {
+    cancelPrefetch();
+
+    presetBankEnabled = enable;
+    presetBank.clear();
+
+    if (enable) {
+        refreshPresetBank();
+    }
 }
 
 
-/// <summary
-/// Check if a file exists
+/// <summary>
+/// Scan the preset folder and reload only the presets whose file is new or was modified,
+/// presets whose file is gone are dropped. Call it when the files may have changed outside the manager
 /// </summary>
-bool ofxPresets::fileExist(const std::string& jsonFilePath) {
-    std::ifstream file(jsonFilePath);
-    if (!file.is_open()) {
+void ofxPresets::refreshPresetBank() {
+    if (!presetBankEnabled || params == nullptr) {
+        return;
+    }
+
+    std::error_code error;
+    std::string archiveError;
+    if (archive.isOpen() && !archive.reload(archiveError)) {
+        ofLogError("ofxPresets::refreshPresetBank") << "Could not reload " << archive.getPath() << ": " << archiveError;
+    }
+
+    buildPresetIndex();
+
+    for (int id : presetIndex) {
+        auto cached = presetBank.find(id);
+        if (cached == presetBank.end()) {
+            loadBankEntry(id);
+        }
+        else if (archive.isOpen()) {
+            ofxPresetsArchive::Entry archived;
+            if (archive.find(id, archived) && archived.offset != cached->second.archiveOffset) {
+                loadBankEntry(id);
+            }
+        }
+        else if (cached->second.modified != std::filesystem::last_write_time(presetFilePath(id), error)) {
+            loadBankEntry(id);
+        }
+    }
+
+    for (auto it = presetBank.begin(); it != presetBank.end();) {
+        if (!std::binary_search(presetIndex.begin(), presetIndex.end(), it->first)) {
+            ofLog(OF_LOG_VERBOSE) << "ofxPresets::refreshPresetBank:: Preset " << it->first << " removed";
+            it = presetBank.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::refreshPresetBank:: " << presetBank.size() << " presets in the bank";
+}
+
+
+/// <summary>
+/// Read and decode a single preset into the bank
+/// </summary>
+void ofxPresets::loadBankEntry(int id) {
+    ofxPresetsBankEntry entry;
+    if (archive.isOpen()) {
+        ofxPresetsArchive::Entry archived;
+        if (archive.find(id, archived)) {
+            entry.archiveOffset = archived.offset;
+        }
+    }
+    else {
+        std::error_code error;
+        entry.modified = std::filesystem::last_write_time(presetFilePath(id), error);
+    }
+
+    invalidateBlend(id);
+    if (readPreset(id, entry.targets)) {
+        ofLog(OF_LOG_VERBOSE) << "ofxPresets::loadBankEntry:: Preset " << id << " loaded into the bank";
+        presetBank[id] = std::move(entry);
+    }
+    else {
+        presetBank.erase(id);
+    }
+}
+
+
+#pragma endregion
+
+
+
+/// <summary>
+/// Serialize decoded preset values as the bytes of a preset file
+/// </summary>
+/// <param name="compact">json without indentation</param>
+void ofxPresets::encodePreset(const ofxPresetsTargetSet& targets, bool binary, bool compact, std::vector<uint8_t>& bytes) {
+    if (binary) {
+        ofxPresetsBinary::encode(schemaHash, targets, bytes);
+        return;
+    }
+    std::string text = encodeJson(targets).dump(compact ? -1 : 4); // Pretty print with 4 spaces
+    bytes.assign(text.begin(), text.end());
+}
+
+
+/// <summary>
+/// Runs on the save thread: serialize a snapshot and write it, to a temporary file renamed over the preset file,
+/// or to the archive. The result is notified from update()
+/// </summary>
+void ofxPresets::writeSaveJob(const ofxPresetsSaveJob& job) {
+    std::vector<uint8_t> bytes;
+    encodePreset(job.targets, job.binary, job.compactJson, bytes);
+
+    ofxPresetsSaveEventArgs result;
+    result.id = job.id;
+    std::string error;
+
+    if (job.toArchive) {
+        result.location = archive.getPath();
+        result.success = archive.put(job.id, job.binary ? ofxPresetsArchive::Binary : ofxPresetsArchive::Json, bytes.data(), bytes.size());
+        if (!result.success) {
+            error = "could not write to the archive";
+        }
+    }
+    else {
+        result.location = job.filePath;
+        result.success = ofxPresetsSafeFile::write(job.filePath, bytes.data(), bytes.size(), error);
+        if (result.success) {
+            // drop the file in the other format, it would be outdated
+            std::error_code removeError;
+            std::filesystem::remove(job.otherFilePath, removeError);
+        }
+    }
+
+    if (!result.success) {
+        ofLogError("ofxPresets::writeSaveJob") << "Could not save preset " << job.id << " to " << result.location << ": " << error;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(savingPresetsMutex);
+        auto saving = savingPresets.find(job.id);
+        if (saving != savingPresets.end() && saving->second.get() == &job) {
+            savingPresets.erase(saving); // written, unless the preset was saved again since
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(completedSavesMutex);
+        completedSaves.push_back(result);
+    }
+    pendingSaves--;
+}
+
+
+/// <summary>
+/// Copy the values of a preset that is queued or being written by the save worker, from any thread
+/// </summary>
+/// <returns>false if the preset has no save pending, it is then read from its file or the archive</returns>
+bool ofxPresets::readSavingPreset(int id, ofxPresetsTargetSet& targets) {
+    std::lock_guard<std::mutex> lock(savingPresetsMutex);
+    auto saving = savingPresets.find(id);
+    if (saving == savingPresets.end()) {
         return false;
     }
+    targets = saving->second->targets;
     return true;
 }
 
+
 /// <summary>
-/// Sets the relative path to the folder where the presets will be saved and loaded
+/// Finish the saves written since the last call and notify presetSaved, on the calling (main) thread
 /// </summary>
-/// <param name="path">example: "data\\presets\\"</param>
-void ofxPresets::setFolderPath(const std::string& path) {
-    folderPath = path;
-	
-    if (!std::filesystem::exists(folderPath)) {
-		ofLog(OF_LOG_NOTICE) << "ofxPresets::setFolderPath:: Creating folder " << folderPath;
-		std::filesystem::create_directory(folderPath);
-	}
+void ofxPresets::processCompletedSaves() {
+    std::vector<ofxPresetsSaveEventArgs> results;
+    {
+        std::lock_guard<std::mutex> lock(completedSavesMutex);
+        results.swap(completedSaves);
+    }
+
+    for (auto& result : results) {
+        if (result.success) {
+            // the bank already has the values, only the file stamp is new
+            auto cached = presetBank.find(result.id);
+            if (cached != presetBank.end()) {
+                ofxPresetsArchive::Entry archived;
+                if (archive.isOpen() && archive.find(result.id, archived)) {
+                    cached->second.archiveOffset = archived.offset;
+                }
+                else if (!archive.isOpen()) {
+                    std::error_code error;
+                    cached->second.modified = std::filesystem::last_write_time(result.location, error);
+                }
+            }
+            if (archive.isOpen() && archive.needsCompaction()) {
+                compactArchive();
+            }
+        }
+        else {
+            // nothing was written, follow what is stored
+            buildPresetIndex();
+            if (presetBankEnabled) {
+                loadBankEntry(result.id);
+            }
+        }
+
+        ofNotifyEvent(presetSaved, result, this);
+    }
 }
 
 
 /// <summary>
-/// Verify if an associated json file exists for a given preset ID
+/// Block until the queued saves are written, without notifying them
 /// </summary>
-/// <param name="id"></param>
-/// <returns></returns>
-bool ofxPresets::presetExist(int id) {
-    auto file = convertIDtoJSonFilename(id);
-    return fileExist(file);
+void ofxPresets::flushSaves() {
+    if (pendingSaves.load() > 0) {
+        saveWorker.wait();
+    }
 }
 
 
+/// <summary>
+/// Block until every queued save is written, and notify presetSaved for them.
+/// i.e. before exiting, or to copy the preset files right after saving
+/// </summary>
+void ofxPresets::waitForSaves() {
+    flushSaves();
+    processCompletedSaves();
+}
+
 
 /// <summary>
-/// Delete a preset file
+/// Save json presets without indentation, smaller and faster to write
 /// </summary>
-/// <param name="id"></param>
-void ofxPresets::deletePreset(int id) {
-    std::string jsonFilePath = convertIDtoJSonFilename(id);
-    if (fileExist(jsonFilePath)) {
-        std::remove(jsonFilePath.c_str());
-        ofLog(OF_LOG_VERBOSE) << "ofxPresets::deletePreset" << "Preset " << id << " deleted";
+/// <param name="compact">false (default) writes them indented with 4 spaces</param>
+void ofxPresets::setCompactJson(bool compact) {
+    compactJson = compact;
+}
+
+
+/// <summary>
+/// Choose the file format used to save presets
+/// Applying presets reads either format, whatever this setting is
+/// </summary>
+/// <param name="format">Json, Binary, or Auto (default): json, binary from BINARY_PRESET_THRESHOLD parameters</param>
+void ofxPresets::setPresetFormat(ofxPresetsFileFormat format) {
+    presetFormat = format;
+}
+
+
+bool ofxPresets::useBinaryFormat(ofxPresetsFileFormat format) const {
+    if (format == ofxPresetsFileFormat::Auto) {
+        return bindings.size() >= BINARY_PRESET_THRESHOLD;
+    }
+    return format == ofxPresetsFileFormat::Binary;
+}
+
+
+/// <summary>
+/// Rewrite an existing preset in another file format, the previous file is removed.
+/// Converting from json drops the values of parameters that are not managed
+/// </summary>
+/// <param name="format">Json or Binary. Auto picks the format savePreset would use</param>
+/// <returns>false if the preset could not be read or written</returns>
+bool ofxPresets::convertPreset(int id, ofxPresetsFileFormat format) {
+    flushSaves();
+    if (!presetIndexBuilt) {
+        buildPresetIndex();
+    }
+    if (!std::binary_search(presetIndex.begin(), presetIndex.end(), id)) {
+        ofLogError("ofxPresets::convertPreset") << "Preset file does not exist for ID: " << id;
+        return false;
+    }
+
+    bool binary = useBinaryFormat(format);
+
+    if (archive.isOpen()) {
+        ofxPresetsArchive::Entry archived;
+        if (archive.find(id, archived) && (archived.format == ofxPresetsArchive::Binary) == binary) {
+            return true;
+        }
+
+        ofxPresetsTargetSet targets;
+        if (!readArchivePreset(id, targets)) {
+            return false;
+        }
+
+        std::vector<uint8_t> bytes;
+        encodePreset(targets, binary, compactJson, bytes);
+        if (!archive.put(id, binary ? ofxPresetsArchive::Binary : ofxPresetsArchive::Json, bytes.data(), bytes.size())) {
+            ofLogError("ofxPresets::convertPreset") << "Could not write preset " << id << " to " << archive.getPath();
+            return false;
+        }
+        if (presetBankEnabled) {
+            loadBankEntry(id);
+        }
+        return true;
+    }
+
+    std::string fromFilePath = presetFilePath(id);
+    if (isBinaryFilePath(fromFilePath) == binary) {
+        return true;
+    }
+
+    ofxPresetsTargetSet targets;
+    if (!readPresetFile(fromFilePath, targets)) {
+        return false;
+    }
+
+    std::string toFilePath = binary ? convertIDtoBinaryFilename(id) : convertIDtoJSonFilename(id);
+    std::vector<uint8_t> bytes;
+    encodePreset(targets, binary, compactJson, bytes);
+    std::string writeError;
+    if (!ofxPresetsSafeFile::write(toFilePath, bytes.data(), bytes.size(), writeError)) {
+        ofLogError("ofxPresets::convertPreset") << "Could not write " << toFilePath << ": " << writeError;
+        return false;
     }
+
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::convertPreset:: Preset " << id << " converted to " << toFilePath;
+    std::error_code error;
+    std::filesystem::remove(fromFilePath, error);
+    addToPresetIndex(id, binary);
+
+    if (presetBankEnabled) {
+        loadBankEntry(id);
+    }
+    return true;
 }
 
 
+/// <summary>
+/// Rewrite every existing preset in another file format, inside the archive when one is open
+/// </summary>
+void ofxPresets::convertAllPresets(ofxPresetsFileFormat format) {
+    cancelPrefetch();
+    prefetchWorker.wait(); // the worker may be reading the files
+
+    buildPresetIndex();
+    std::vector<int> ids = presetIndex;
+    for (int id : ids) {
+        convertPreset(id, format);
+    }
+}
 
 
+#pragma region updateParameters
+
 /// <summary>
-/// Clone a preset to another preset
+/// Update the parameters with the interpolation data towards the target values
 /// </summary>
-void ofxPresets::clonePresetTo(int from, int to) {
-    std::string fromJsonFilePath = convertIDtoJSonFilename(from);
-    std::string toJsonFilePath = convertIDtoJSonFilename(to);
+/// <param name="parameterGroups"></param>
+void ofxPresets::updateParameters() {
+    if (!interpolator.isActive()) {
+        return;
+    }
 
-    if (fileExist(fromJsonFilePath)) {
-        ofLog(OF_LOG_VERBOSE) << "ofxPresets::clonePresetTo:: Cloning preset " << from << " to " << to;
-        std::ifstream src(fromJsonFilePath, std::ios::binary);
-        std::ofstream dst(toJsonFilePath, std::ios::binary);
-        dst << src.rdbuf();
-        dst.close();
+    float t = interpolationTime(currentTime);
+
+    if (interpolationPending) {
+        // the values of this frame were computed by the worker during the previous one
+        {
+            OFX_PRESETS_STATS_TIME(stats, Interpolate);
+            interpolationWorker.wait();
+        }
+        interpolator.swapBuffers();
+        interpolationPending = false;
+        t = pendingT;
+        interpolationLatency = currentTime - pendingTime;
     }
     else {
-        ofLog(OF_LOG_ERROR) << "ofxPresets::clonePresetTo:: No json file for source preset " << from << ". Looking for " << toJsonFilePath;
+        evaluateInterpolation(t, false);
+        interpolationLatency = 0.0;
+    }
+    OFX_PRESETS_STATS_DO(stats.setInterpolationLatency(interpolationLatency));
+
+    applyLaneValues(interpolator);
+
+    if (t >= 1.0f) { // it means (currentTime - interpolator.startTime >= transitionDuration)
+        interpolator.clear();
+        onTransitionFinished();
+        return;
+    }
+
+    if (threadedInterpolation) {
+        // compute the next frame while the app draws this one, for when it is expected to start
+        pendingTime = currentTime + frameInterval;
+        pendingT = interpolationTime(pendingTime);
+        interpolationPending = true;
+        interpolationWorker.post([this]() { evaluateInterpolation(pendingT, true); });
+    }
+}
+
+
+/// <summary>
+/// Set the bool parameters whose value changed
+/// </summary>
+void ofxPresets::applyBoolValues(const std::vector<uint32_t>& slots, const uint8_t* values) {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        bool value = values[i] != 0;
+        if (value != bindings[slots[i]].as<bool>().get()) {
+            setParameter(slots[i], value);
+        }
+    }
+}
+
+
+/// <summary>
+/// Set the parameters to the current values of the lanes.
+/// Only the values that change are set, so the parameter listeners do not fire for nothing
+/// </summary>
+void ofxPresets::applyLaneValues(const ofxPresetsInterpolator& lanes) {
+    OFX_PRESETS_STATS_TIME(stats, Notify);
+    const auto& ints = lanes.ints;
+    for (size_t i = 0; i < ints.size(); ++i) {
+        int value = static_cast<int>(ints.value[i]);
+        if (value != bindings[ints.slots[i]].as<int>().get()) {
+            setParameter(ints.slots[i], value);
+        }
+    }
+
+    const auto& floats = lanes.floats;
+    for (size_t i = 0; i < floats.size(); ++i) {
+        float value = floats.value[i];
+        if (value != bindings[floats.slots[i]].as<float>().get()) {
+            setParameter(floats.slots[i], value);
+        }
+    }
+
+    const auto& doubles = lanes.doubles;
+    for (size_t i = 0; i < doubles.size(); ++i) {
+        double value = doubles.value[i];
+        if (value != bindings[doubles.slots[i]].as<double>().get()) {
+            setParameter(doubles.slots[i], value);
+        }
+    }
+
+    const auto& colors = lanes.colors;
+    for (size_t i = 0; i < colors.size(); ++i) {
+        const float* c = &colors.value[i * 4];
+        ofColor value(c[0], c[1], c[2], c[3]);
+        if (value != bindings[colors.slots[i]].as<ofColor>().get()) {
+            setParameter(colors.slots[i], value);
+        }
+    }
+
+    applyVectorValues<glm::vec2>(lanes.vec2s);
+    applyVectorValues<glm::vec3>(lanes.vec3s);
+    applyVectorValues<glm::vec4>(lanes.vec4s);
+    applyVectorValues<ofFloatColor>(lanes.floatColors);
+    applyVectorValues<ofRectangle>(lanes.rectangles);
+    applyVectorValues<glm::quat>(lanes.quats);
+
+    notifyChangedParameters();
+}
+
+
+/// <summary>
+/// Set the multi-component parameters of a lane whose value changed
+/// </summary>
+template<typename T>
+void ofxPresets::applyVectorValues(const ofxPresetsInterpolator::Lane<float>& lane) {
+    for (size_t i = 0; i < lane.size(); ++i) {
+        T value = ofxPresetsVectorType<T>::read(&lane.value[i * lane.channels]);
+        if (value != bindings[lane.slots[i]].as<T>().get()) {
+            setParameter(lane.slots[i], value);
+        }
     }
 }
 
 
+/// <summary>
+/// Normalized time of the running transition (between 0 and 1), a zero duration jumps to the targets
+/// </summary>
+float ofxPresets::interpolationTime(double time) const {
+    if (transitionDuration <= 0.0f) {
+        return 1.0f;
+    }
+    double elapsedTime = time - interpolator.startTime;
+    return static_cast<float>(std::clamp(elapsedTime / transitionDuration, 0.0, 1.0));
+}
 
-#pragma endregion
 
+/// <summary>
+/// Interpolate and ease all lanes
+/// </summary>
+/// <param name="toBack">into the back buffers, from the interpolation worker</param>
+void ofxPresets::evaluateInterpolation(float t, bool toBack) {
+    OFX_PRESETS_STATS_TIME(stats, Interpolate);
+    float easedT = easingFunction ? easingFunction(t) : easingCurve(t);
+    interpolator.evaluate(t, easedT, toBack);
+}
 
 
 /// <summary>
-/// Take the given parameters from a vector and saves them as a json file with the parameters and save it to the parameters
+/// Wait for the interpolation worker and drop what it computed,
+/// before the transition changes (new targets, stop, easing)
 /// </summary>
-/// <param name="jsonFilePath"></param>
-/// <param name="parameterGroups"></param>
-void ofxPresets::saveParametersToJson(const std::string& jsonFilePath) {
-    ofLog(OF_LOG_NOTICE) << "ofxPresets::saveParametersToJson:: Saving JSON to esencia parameters to " << jsonFilePath;
+void ofxPresets::dropPendingInterpolation() {
+    if (interpolationPending) {
+        interpolationWorker.wait();
+        interpolationPending = false;
+    }
+}
 
-    ofJson j;
 
-    for (const auto& paramGroup : *params) {
-        ofJson groupJson;
-        for (const auto& [key, param] : paramGroup->parameterMap) {
-            if (param != nullptr) {
-                const std::string paramTypeName = typeid(*param).name();
+/// <summary>
+/// Compute the interpolated values on a worker thread, one frame ahead:
+/// each update() applies the values computed during the previous frame, for the time the current frame was expected at
+/// (the previous frame interval later), and hands the next frame to the worker.
+/// Parameters are still set on the calling thread, so listeners behave the same.
+/// The first frame of a transition is computed right away. getInterpolationLatency() tells how late the applied values are
+/// </summary>
+/// <param name="threaded">false (default) computes each frame in update()</param>
+void ofxPresets::setThreadedInterpolation(bool threaded) {
+    dropPendingInterpolation();
+    threadedInterpolation = threaded;
+}
 
-                try {
-                    if (paramTypeName == typeid(ofParameter<bool>).name()) {
-                        groupJson[key] = dynamic_cast<ofParameter<bool>*>(param)->get();
-                    }
-                    else if (paramTypeName == typeid(ofParameter<int>).name()) {
-                        groupJson[key] = dynamic_cast<ofParameter<int>*>(param)->get();
-                    }
-                    else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                        groupJson[key] = dynamic_cast<ofParameter<float>*>(param)->get();
-                    }
-                    else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                        ofColor color = dynamic_cast<ofParameter<ofColor>*>(param)->get();
-                        groupJson[key] = color.getHex();
-                        groupJson[key + "_alpha"] = color.a;
-                    }
-                }
-                catch (const std::exception& e) {
-                    ofLogError() << "ofxPresets::saveParametersToJson:: Error saving value for key " << key << ": " << e.what();
-                }
-            }
-        }
-        j[paramGroup->groupName] = groupJson; // Assuming the first key is the group name
-    }
 
-    std::ofstream file(jsonFilePath);
-    if (file.is_open()) {
-        file << j.dump(4); // Pretty print with 4 spaces
-        file.close();
+/// <summary>
+/// Set a parameter value, silently when batching notifications
+/// </summary>
+template<typename T>
+void ofxPresets::setParameter(size_t slot, const T& value) {
+    OFX_PRESETS_STATS_DO(stats.addParametersTouched(1));
+    auto& param = bindings[slot].as<T>();
+    if (batchNotifications) {
+        param.setWithoutEventNotifications(value);
+        changedSlots.push_back(slot);
     }
     else {
-        ofLogError() << "ofxPresets::saveParametersToJson:: Could not open JSON file for writing";
+        param.set(value);
     }
 }
 
 
-#pragma region updateParameters
-
 /// <summary>
-/// Update the parameters with the interpolation data towards the target values
+/// Send the parameters set silently since the last call, if any
 /// </summary>
-/// <param name="parameterGroups"></param>
-void ofxPresets::updateParameters() {
-    if (interpolationDataMap.empty()) {
+void ofxPresets::notifyChangedParameters() {
+    if (changedSlots.empty()) {
         return;
     }
+    ofNotifyEvent(parametersChanged, changedSlots, this);
+    changedSlots.clear();
+}
 
-    float currentTime = ofGetElapsedTimef();
-    float t;
-
-    for (auto& [group, interpolationData] : interpolationDataMap) {
-        float elapsedTime = currentTime - interpolationData.startTime;
-        t = std::min(elapsedTime / interpolationDuration.get(), 1.0f); // t is the normalized time (value between 0 and 1)
-
-        for (auto& [key, targetValue] : interpolationData.targetValues) {
-
-            // skip _alpha keys, already covered by the color ones
-            if (key.find("_alpha") != std::string::npos) {
-                continue;
-            }
-
-            float startValue = currentParameterValues[group][key];
-            float interpolatedValue = ofxSEeasing::map_clamp(t, 0.0f, 1.0f, startValue, targetValue, easingFunction(t));
-
-            for (auto& paramGroup : *params) {
-                if (paramGroup->groupName == group) {
-                    auto param = paramGroup->parameterMap[key];
-                    const std::string paramTypeName = typeid(*param).name();
 
-                    if (paramTypeName == typeid(ofParameter<int>).name()) {
-                        dynamic_cast<ofParameter<int>*>(param)->set(static_cast<int>(interpolatedValue));
-                    }
-                    else if (paramTypeName == typeid(ofParameter<float>).name()) {
-                        dynamic_cast<ofParameter<float>*>(param)->set(interpolatedValue);
-                    }
-                    else if (paramTypeName == typeid(ofParameter<ofColor>).name()) {
-                        ofColor color;
-                        color.setHex(startValue);
-						color.lerp(ofColor::fromHex(targetValue), t);
-                        if (interpolationData.targetValues.find(key + "_alpha") != interpolationData.targetValues.end()) {
-                            color.a = ofLerp(currentParameterValues[group][key + "_alpha"], interpolationData.targetValues[key + "_alpha"], t);
-                        } else {
-                            color.a = 255;
-                        }
-                        dynamic_cast<ofParameter<ofColor>*>(param)->set(color);
-                    }
-                }
-            }
-        }
-    }
-    if (t >= 1.0f) { // it means (currentTime - interpolationData.startTime >= interpolationData.duration)
-        interpolationDataMap.clear();
-        onTransitionFinished();
-    }
+/// <summary>
+/// Batch the change notifications: the interpolation sets the parameters without firing their own listeners,
+/// and notifies parametersChanged once per frame with the slots of the parameters that changed.
+/// Use getParameter(slot) to get each one
+/// </summary>
+/// <param name="batch">false (default) fires the listeners of each parameter on set()</param>
+void ofxPresets::setBatchNotifications(bool batch) {
+    notifyChangedParameters();
+    batchNotifications = batch;
 }
 
 #pragma endregion
@@ -827,16 +2853,58 @@ void ofxPresets::updateParameters() {
 
 
 /// <summary>
-/// Load the given sequence string into the sequence vector
+/// Load the given sequence string, see ofxPresetsSequenceParser for the syntax.
+/// An invalid string is reported with the character it fails at and leaves the loaded sequence as it is
 /// </summary>
 /// <param name="seqString"></param>
-void ofxPresets::loadSequence(const std::string& seqString) {
+/// <returns>false if the string is not a valid sequence</returns>
+bool ofxPresets::loadSequence(const std::string& seqString) {
+    ofxPresetsSequenceError error;
+    if (!ofxPresetsSequenceParser::parse(seqString, parsedSequence, error)) {
+        size_t from = error.position > 10 ? error.position - 10 : 0;
+        ofLogError("ofxPresets::loadSequence") << "Invalid sequence, " << error.message << " at character " << error.position
+            << ": \"" << seqString.substr(from, error.position - from) << ">>" << seqString.substr(error.position, 10) << "\"";
+        return false;
+    }
+
     this->sequenceString = seqString;
+    sequence.swap(parsedSequence);
+    if (!isPlaying) {
+        sequenceTransition = interpolationDuration.get();
+    }
+    compileTimeline();
+    cancelPrefetch();
+
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::loadSequence:: Sequence loaded, " << sequence.size() << " steps";
+    return true;
+}
+
+
+/// <summary>
+/// Removes the characters that are not part of the sequence syntax, spaces included.
+/// loadSequence() does not need it, it rejects them and tells where they are
+/// </summary>
+/// <param name="input"></param>
+/// <returns></returns>
+std::string ofxPresets::removeInvalidCharacters(const std::string& input) {
+    std::string result;
+    std::copy_if(input.begin(), input.end(), std::back_inserter(result), ofxPresetsSequenceParser::isSyntaxCharacter);
+    return result;
+}
 
-    sequence.set(parseSequence(this->sequenceString));
-    sequenceIndex = 0;
 
-    ofLog(OF_LOG_NOTICE) << "ofxPresets::loadSequence:: Sequence loaded " << ofToString(sequence.get());
+/// <summary>
+/// Load a sequence of single steps, with the default times
+/// </summary>
+/// <param name="steps">presets, 0 for a random preset and negative for a mutation</param>
+void ofxPresets::setSequence(const std::vector<int>& steps) {
+    sequence.assign(steps);
+    this->sequenceString = sequence.toString();
+    if (!isPlaying) {
+        sequenceTransition = interpolationDuration.get();
+    }
+    compileTimeline();
+    cancelPrefetch();
 }
 
 
@@ -858,17 +2926,21 @@ void ofxPresets::playSequence(float presetDuration, float transitionDuration) {
     ofLogNotice("ofxPresets::playSequence") << "Playing the loaded sequence with transition and preset durations: " << transitionDuration<< ", " << presetDuration;
     this->sequencePresetDuration.set(presetDuration);
     this->interpolationDuration.set(transitionDuration);
+    this->sequenceTransition = transitionDuration;
     this->isPlaying = true;
 
-	// > to ensure the first preset is applied immediately (not waiting for the presetDuration to happen)
-	this->isTransitioning = false;
-	this->lastUpdateTime = ofGetElapsedTimef() - presetDuration;
-	this->sequenceIndex = 0;
+    // the first step is due right away
+    sequenceStartTime = currentTime;
+    nextStepStart = 0.0;
+    compileTimeline();
 
-    if (sequence.get().size() == 0) {
+    if (sequence.empty()) {
         ofLogVerbose() << "ofxPresets::playSequence:: No sequence to play";
         return;
     }
+
+    cancelPrefetch();
+    prefetchSequence();
 }
 
 
@@ -878,239 +2950,598 @@ void ofxPresets::playSequence(float presetDuration, float transitionDuration) {
 void ofxPresets::stopSequence() {
     ofLog(OF_LOG_VERBOSE) << "ofxPresets::stopSequence:: Stopping sequence";
     this->isPlaying = false;
-    sequenceIndex = 0;
+    sequenceCursor.seek(0);
+    sequenceStepNumber = 0;
+    cancelPrefetch();
 }
 
 
 
-// Update the sequencer
+/// <summary>
+/// Start the steps that are due. Each step is timed from the start of the sequence, not from the frame it was applied on,
+/// so late frames do not push the following steps back
+/// </summary>
 void ofxPresets::updateSequence() {
-    if (isPlayingSequence()) {
-        float currentTime = ofGetElapsedTimef();
+    if (!isPlaying || sequence.empty()) {
+        return;
+    }
 
-        if (isTransitioning) {
-            if (currentTime - lastUpdateTime >= interpolationDuration.get()) {
-                isTransitioning = false;
-                lastUpdateTime = currentTime;
-            }
-        }
-        else {
-            if (currentTime - lastUpdateTime >= sequencePresetDuration.get()) {
-                lastUpdateTime = currentTime;
-                applyPreset(sequence.get()[sequenceIndex], interpolationDuration.get());
-                advanceSequenceIndex();
-                isTransitioning = true;
-                onPresetFinished();
-            }
-        }
+    double time = currentTime - sequenceStartTime;
+    if (time < nextStepStart) {
+        return;
+    }
+
+    double stepStart = nextStepStart;
+    const ofxPresetsTimelineEvent step = timeline[sequenceCursor.index()];
+    if (timeline.duration() > 0.0 && time >= stepStart + step.transition + step.hold) {
+        // a long frame went past whole steps, start the one playing now
+        seekSequenceStep(time, stepStart);
     }
+
+    startSequenceStep(stepStart);
+    onPresetFinished();
+    updateParameters(); // the step started before this frame, set its values at this frame's time
 }
 
 
 /// <summary>
-/// Move to the next step in the sequence. Restart if the end is reached
+/// Apply the current step with its transition started at stepStart, and move to the next one
 /// </summary>
-void ofxPresets::advanceSequenceIndex() {
-    sequenceIndex++;
-    if (sequenceIndex >= sequence.get().size()) {
-        sequenceIndex = 0;
+/// <param name="stepStart">in seconds from the start of the sequence</param>
+void ofxPresets::startSequenceStep(double stepStart) {
+    const ofxPresetsTimelineEvent step = timeline[sequenceCursor.index()];
+
+    uint32_t generation = interpolator.getGeneration();
+    applySequenceStep(step.transition);
+    if (interpolator.getGeneration() != generation) {
+        interpolator.startTime = sequenceStartTime + stepStart; // when it was due, not this frame
     }
+
+    nextStepStart = stepStart + step.transition + step.hold;
+    advanceSequenceIndex();
+    prefetchSequence(); // decode the next steps while this one holds
 }
 
 
-#pragma endregion
+/// <summary>
+/// Jump to a time of the loaded sequence and rebuild the parameters at that time, without playing the steps before it:
+/// the preset of the previous step is set right away, then the step playing at that time starts from it, its transition
+/// already advanced. Presets that do not have all the parameters leave the others as they are. Random and mutation steps
+/// draw from the seed and their place in the sequence, so they give the values playing gave them.
+/// transitionFinished is not sent for the jump. Works while playing or stopped
+/// </summary>
+/// <param name="time">seconds from the start of the sequence, past its duration it loops</param>
+void ofxPresets::seek(double time) {
+    if (sequence.empty()) {
+        return;
+    }
 
+    stopInterpolating();
+    cancelPrefetch();
+
+    double stepStart = 0.0;
+    seekSequenceStep(time, stepStart);
+    sequenceStartTime = currentTime - std::max(time, 0.0);
+
+    // the end of the previous step, the first step of the sequence starts from the current values
+    if (sequenceStepNumber > 0) {
+        uint64_t previous = (sequenceCursor.index() + sequence.size() - 1) % sequence.size();
+        ofxPresetsRandom generator = stepRandom(sequenceStepNumber - 1);
+        startPreset(pickSequencePreset(sequence[previous], generator), 0.0f, generator);
+        completeTransition();
+    }
 
+    const uint64_t index = sequenceCursor.index();
+    startSequenceStep(stepStart);
+    if (interpolationTime(currentTime) >= 1.0f) {
+        completeTransition(); // landed in the hold of the step
+    }
+    else {
+        updateParameters();
+    }
 
+    ofLog(OF_LOG_VERBOSE) << "ofxPresets::seek:: Step " << index << " at " << time << "s";
+}
 
-#pragma region Listeners
 
 /// <summary>
-/// Event to notify that a preset has finished
+/// Move the cursor to the step playing at a time of the sequence, counting the loops before it
 /// </summary>
-void ofxPresets::onPresetFinished() {
-    ofLogVerbose("ofxPresets::onPresetFinished") << "Sequence preset's waiting time finished";
-    ofNotifyEvent(sequencePresetFinished, this);
+/// <param name="time">seconds from the start of the sequence</param>
+/// <param name="stepStart">start of that step, in seconds from the start of the sequence</param>
+void ofxPresets::seekSequenceStep(double time, double& stepStart) {
+    sequenceCursor.seek(timeline.find(time, stepStart));
+    const double loop = timeline.duration() > 0.0 ? std::floor(std::max(time, 0.0) / timeline.duration()) : 0.0;
+    sequenceStepNumber = static_cast<uint64_t>(loop) * sequence.size() + sequenceCursor.index();
 }
 
 
 /// <summary>
-/// Event to notify that a transition interpolation has finished, happens for direct preset apply and sequence transitions
+/// Set the end values of the running transition and stop it, without transitionFinished: for jumps, not transitions
 /// </summary>
-void ofxPresets::onTransitionFinished() {
-    ofLogVerbose("ofxPresets::onTransitionFinished") << "Preset transition finished";
-    ofNotifyEvent(transitionFinished, this);
+void ofxPresets::completeTransition() {
+    if (!interpolator.isActive()) {
+        return;
+    }
+    dropPendingInterpolation();
+    evaluateInterpolation(1.0f, false);
+    applyLaneValues(interpolator);
+    interpolator.clear();
 }
 
 
 /// <summary>
-/// NOT IN USE
-/// Event to notify that a transition has finished
+/// Lay out the sequence in time, with the times of its steps or the current sequencePresetDuration and the transition
+/// the sequence was played or loaded with.
+/// While playing, the new timeline starts with its first step when the next step was due
 /// </summary>
-//void ofxPresets::onSequenceFinished() {
-//    ofLogVerbose("ofxPresets::onSequenceFinished") << "Sequence finished";
-//    ofNotifyEvent(sequenceFinished, this);
-//}
+void ofxPresets::compileTimeline() {
+    timeline.compile(sequence, sequencePresetDuration.get(), sequenceTransition);
+    sequenceCursor.seek(0);
+    sequenceStepNumber = 0;
+    sequenceStartTime += nextStepStart;
+    nextStepStart = 0.0;
+}
 
 
-#pragma endregion
+/// <summary>
+/// Move to the next step in the sequence. Restart if the end is reached
+/// </summary>
+void ofxPresets::advanceSequenceIndex() {
+    sequenceCursor.advance();
+    ++sequenceStepNumber;
+}
 
 
+/// <summary>
+/// Preset to play for a step of the sequence: random steps pick one of their choices by weight,
+/// or any existing preset when they have none. Mutations keep their negative id
+/// </summary>
+/// <param name="generator">of the step, see stepRandom()</param>
+int ofxPresets::pickSequencePreset(const ofxPresetsSequenceStep& step, ofxPresetsRandom& generator) {
+    if (step.presetId != 0) {
+        return step.presetId;
+    }
+    if (step.choiceCount == 0) {
+        return getRandomPreset(1, MAX_RANDOM_PRESET, generator);
+    }
 
+    auto first = sequence.choices.begin() + step.firstChoice;
+    auto last = first + step.choiceCount;
+    float total = 0.0f;
+    for (auto choice = first; choice != last; ++choice) {
+        total += choice->weight;
+    }
+    float pick = generator.uniform(0.0f, total);
+    for (auto choice = first; choice != last; ++choice) {
+        if (pick < choice->weight) {
+            return choice->presetId;
+        }
+        pick -= choice->weight;
+    }
+    return (last - 1)->presetId; // rounding, or all weights 0
+}
 
-#pragma region Parsing
 
 /// <summary>
-/// Parse an string sequence into a vector of integers
-/// example: "1, 2, 3 - 6, 2" turns into [1, 2, 3, 4, 5, 6, 2]
-/// example: "1, ? - 3, 2, ?" turns into [1, 0, 0, 0, 2, 0]
+/// Apply the preset of the current sequence step.
+/// Uses the prefetched values when they are ready, otherwise loads it right away
 /// </summary>
-/// <param name="input">allows: Numbers, commas, dashes and question mark</param>
-std::vector<int> ofxPresets::parseSequence(std::string& input) {
-    std::vector<int> s;
-
-    input = removeInvalidCharacters(input);
-
-    std::istringstream stream(input);
-    std::string token;
+/// <param name="duration">of the transition of the step</param>
+void ofxPresets::applySequenceStep(float duration) {
+    if (sequence.empty()) {
+        return;
+    }
 
-    // TODO: Better use regex to validate and organize parsing each section
+    if (!prefetchedSteps.empty()) {
+        auto step = prefetchedSteps.front();
+        prefetchedSteps.pop_front();
 
-    while (std::getline(stream, token, ',')) {
+        if (step->stepNumber == sequenceStepNumber) {
+            if (!step->ready.load(std::memory_order_acquire)) {
+                // not decoded in time, read here
+                ofLog(OF_LOG_VERBOSE) << "ofxPresets::applySequenceStep:: Step " << sequenceCursor.index() << " was not prefetched in time";
+                startPreset(step->presetId, duration, step->random);
+                return;
+            }
+            if (!step->valid) {
+                startPreset(step->presetId, duration, step->random); // reports the missing preset
+                return;
+            }
 
-        // Handle ranges
-        if (token.find('-') != std::string::npos) {
-            std::vector<int> sr = unfoldRanges(token);
-            for (auto& i : sr) {
-                s.push_back(i);
+            ofLog(OF_LOG_NOTICE) << "ofxPresets::applySequenceStep:: Applying prefetched preset " << step->presetId;
+            applyTargets(step->targets, duration);
+            if (step->presetId < 0) {
+                mutateTargets(interpolator, mutationPercentage, step->random);
             }
+            lastAppliedPreset = step->presetId;
+            presetAppicationStarted.notify();
+            return;
         }
 
-        // Handle random presets
-        else if (token.find('?') != std::string::npos) {
-            s.push_back(0);
-        }
+        // out of order, start over from the current step
+        ofLog(OF_LOG_VERBOSE) << "ofxPresets::applySequenceStep:: Step " << sequenceCursor.index() << " was not prefetched";
+        cancelPrefetch();
+    }
 
-        // Handle mutation
-        else if (token.find('*') != std::string::npos) {
-            int mutationPreset;
-            if (token.find('*') == 0) {
-				mutationPreset = std::stoi(token.substr(1, token.length()-1));
-            }
-            else {
-				mutationPreset = std::stoi(token.substr(0, token.find('*')));
-            }
-            //mutationPreset = std::stoi(token.substr(1));
-            s.push_back(-mutationPreset);
-        }
+    ofxPresetsRandom generator = stepRandom(sequenceStepNumber);
+    startPreset(pickSequencePreset(sequenceCursor.step(), generator), duration, generator);
+}
 
-        // Handle single numbers
-        else {
-            s.push_back(std::stoi(token));
-        }
+
+/// <summary>
+/// Set how many upcoming sequence steps are decoded ahead on a worker thread
+/// </summary>
+/// <param name="steps">0 disables the prefetch. Default 2</param>
+void ofxPresets::setSequencePrefetch(int steps) {
+    sequencePrefetch = std::max(steps, 0);
+    cancelPrefetch();
+    if (isPlaying) {
+        prefetchSequence();
     }
-    return s;
 }
 
+
 /// <summary>
-/// Returns a vector of strings from a string separated by a delimiter
+/// Queue the decoding of the next steps, keeping sequencePrefetch steps ahead of the current one.
+/// Not needed when the preset bank is enabled, presets are already decoded there
 /// </summary>
-/// <param name="str"></param>
-/// <param name="delimiter">","</param>
-std::vector<std::string> ofxPresets::splitString(const std::string& str, char delimiter) const {
-    std::vector<std::string> parts;
-    std::istringstream stream(str);
-    std::string part;
+void ofxPresets::prefetchSequence() {
+    if (sequencePrefetch <= 0 || presetBankEnabled || sequence.empty()) {
+        return;
+    }
+    // the step after the ones already prefetched
+    ofxPresetsSequence::Cursor cursor = sequenceCursor;
+    for (size_t i = 0; i < prefetchedSteps.size(); ++i) {
+        cursor.advance();
+    }
+
+    while (prefetchedSteps.size() < static_cast<size_t>(sequencePrefetch)) {
+        auto step = std::make_shared<ofxPresetsPrefetchedStep>();
+        step->stepNumber = sequenceStepNumber + prefetchedSteps.size();
+        step->random = stepRandom(step->stepNumber);
+        step->presetId = pickSequencePreset(cursor.step(), step->random); // random steps are picked now, mutations keep their negative id
+        cursor.advance();
+        prefetchedSteps.push_back(step);
+
+        if (!presetExist(std::abs(step->presetId))) {
+            step->ready.store(true, std::memory_order_release); // nothing to decode, reported when applied
+            continue;
+        }
+        if (readSavingPreset(std::abs(step->presetId), step->targets)) {
+            step->valid = true; // not written yet, the file may still hold the previous values
+            step->ready.store(true, std::memory_order_release);
+            continue;
+        }
 
-    while (std::getline(stream, part, delimiter)) {
-        parts.push_back(part);
+        std::string filePath = archive.isOpen() ? std::string() : presetFilePath(std::abs(step->presetId));
+        prefetchWorker.post([this, step, filePath]() { decodePrefetchedStep(*step, filePath); });
     }
-    return parts;
 }
 
 
 /// <summary>
-/// Convert a "1-5" string into a vector of integers {1, 2, 3, 4, 5}
-/// Using ?-N produces N times a random preset. i.e. "?-3" = {0, 0, 0}
+/// Forget the prefetched steps, a job already running just finishes on its own copy
+/// </summary>
+void ofxPresets::cancelPrefetch() {
+    prefetchWorker.clear();
+    prefetchedSteps.clear();
+}
+
+
+/// <summary>
+/// Runs on the worker thread: decode the preset file of a step, or read it from the archive when filePath is empty.
+/// Mutations are decoded from their source preset, the mutation itself happens when applied
 /// </summary>
-std::vector<int> ofxPresets::unfoldRanges(std::string& str) {
-    std::vector<int> sr;
-    int start = 1;
-    int end = 1;
+void ofxPresets::decodePrefetchedStep(ofxPresetsPrefetchedStep& step, const std::string& filePath) {
+    step.valid = filePath.empty() ? readArchivePreset(std::abs(step.presetId), step.targets) : readPresetFile(filePath, step.targets);
+    step.ready.store(true, std::memory_order_release);
+}
+
+
+#pragma endregion
+
+
+
 
-    auto rangeParts = splitString(str, '-');
+#pragma region Baking
 
-    if (rangeParts.size() == 2) {
 
-		// handle random presets
-        if (rangeParts[0].find('?') != std::string::npos || rangeParts[0].find('?') != std::string::npos) {
-			return unfoldRandomRange(rangeParts);
+/// <summary>
+/// Render the loaded sequence at a fixed frame rate into a track file, faster than real time.
+/// The frames are rendered one batch at a time. For each batch the calling thread resolves the steps its frames cross, in order:
+/// presets read, random steps picked and mutations applied, and eases the frame times.
+/// Then the frames are interpolated in parallel, each core a range of frames, with the same lanes and easing as the live transitions.
+/// Only the values around the steps of one batch are kept, and easingFunction is only called from the calling thread.
+/// The track starts from the current values, like playSequence(), and is played back with playTrack()
+/// </summary>
+/// <param name="fps">frames per second</param>
+/// <param name="duration">seconds, negative (default) for one loop of the sequence</param>
+/// <returns>false if there is nothing to bake or the file could not be written</returns>
+bool ofxPresets::bakeSequence(const std::string& trackPath, double fps, double duration) {
+    if (sequence.empty() || fps <= 0.0) {
+        ofLogError("ofxPresets::bakeSequence") << "No sequence loaded, or no frame rate";
+        return false;
+    }
+    if (duration < 0.0) {
+        duration = timeline.duration();
+    }
+    const uint64_t frames = static_cast<uint64_t>(std::ceil(duration * fps));
+    if (frames == 0 || timeline.duration() <= 0.0) {
+        ofLogError("ofxPresets::bakeSequence") << "The sequence has no duration";
+        return false;
+    }
+
+    // the values at the end of the steps resolved so far, reached by the transition of step resolved - 1
+    const size_t stepCount = timeline.size();
+    const size_t steps = static_cast<size_t>(std::ceil(duration / timeline.duration())) * stepCount;
+    ofxPresetsTargetSet state;
+    captureTargets(state);
+    size_t resolved = 0;
+
+    std::vector<uint32_t> position(bindings.size(), 0);
+    ofxPresetsTargetSet::forEachLane([&position](const auto& lane) {
+        for (size_t i = 0; i < lane.size(); ++i) {
+            position[lane.slots[i]] = static_cast<uint32_t>(i);
         }
+    }, state);
+
+    ofxPresetsInterpolator mutation;
+    mutation.colorSpace = interpolator.colorSpace;
+    ofxPresetsSequence::Cursor cursor(sequence);
+    auto resolveStep = [&]() {
+        ofxPresetsRandom generator = stepRandom(resolved); // the values playing the sequence gives the step
+        int id = pickSequencePreset(cursor.step(), generator);
+
+        ofxPresetsTargetSet preset;
+        if (!fetchPreset(std::abs(id), preset)) {
+            ofLog(OF_LOG_WARNING) << "ofxPresets::bakeSequence:: No preset " << std::abs(id) << ", step " << cursor.index() << " holds the previous values";
+        }
+        if (id < 0) {
+            mutation.clear();
+            mutation.add(preset);
+            mutateTargets(mutation, mutationPercentage, generator);
+            mutation.copyTargets(preset);
+        }
+
+        ofxPresetsTargetSet::forEachLane([&position](auto& lane, const auto& values) {
+            for (size_t i = 0; i < values.size(); ++i) {
+                auto first = values.values.begin() + i * values.channels;
+                std::copy(first, first + values.channels, lane.values.begin() + position[values.slots[i]] * lane.channels);
+            }
+        }, state, preset);
+        cursor.advance();
+        ++resolved;
+    };
 
-        // regular range
-        start = std::stoi(rangeParts[0]);
-        end = std::stoi(rangeParts[1]);
+    // the frames of a batch: the step they are in, from the start and end values of the batch, and their time in its transition
+    struct Frame {
+        size_t step;
+        float t;
+        float easedT;
+    };
+    std::vector<Frame> batchFrames;
+    std::vector<ofxPresetsTargetSet> stepStarts;
+    std::vector<ofxPresetsTargetSet> stepEnds;
+
+    size_t lastStep = steps; // none yet
+    auto prepareFrames = [&](uint64_t first, uint64_t count) {
+        batchFrames.clear();
+        if (!stepEnds.empty()) {
+            // the last step of the previous batch can go on into this one
+            stepStarts.erase(stepStarts.begin(), stepStarts.end() - 1);
+            stepEnds.erase(stepEnds.begin(), stepEnds.end() - 1);
+        }
+        for (uint64_t frame = first; frame < first + count; ++frame) {
+            const double time = frame / fps;
+            double stepStart = 0.0;
+            const uint64_t index = timeline.find(time, stepStart);
+            const ofxPresetsTimelineEvent step = timeline[index];
+            const size_t loop = static_cast<size_t>(std::llround((stepStart - step.start) / timeline.duration()));
+            const size_t k = std::min(loop * stepCount + index, steps - 1);
+
+            // the frames go forward, so the steps do too
+            if (k != lastStep) {
+                if (batchFrames.empty()) {
+                    stepStarts.clear();
+                    stepEnds.clear();
+                }
+                while (resolved < k) {
+                    resolveStep();
+                }
+                stepStarts.push_back(state);
+                resolveStep();
+                stepEnds.push_back(state);
+                lastStep = k;
+            }
 
-        // Handle reversed ranges
-        if (start > end) {
-            std::swap(start, end);
+            float t = step.transition > 0.0f ? static_cast<float>(std::clamp((time - stepStart) / step.transition, 0.0, 1.0)) : 1.0f;
+            float easedT = easingFunction ? easingFunction(t) : easingCurve(t);
+            batchFrames.push_back({ stepEnds.size() - 1, t, easedT });
         }
-        
-        for (int i = start; i <= end; ++i) {
-            sr.push_back(i);
+    };
+
+    // one set of lanes per core, each one set up for the step of its frames
+    const size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<ofxPresetsInterpolator> lanes(threads);
+    std::vector<size_t> laneSteps(threads);
+    for (auto& lane : lanes) {
+        lane.colorSpace = interpolator.colorSpace;
+    }
+
+    auto renderFrame = [&](size_t worker, const Frame& frame, uint8_t* row) {
+        ofxPresetsInterpolator& frameLanes = lanes[worker];
+        if (laneSteps[worker] != frame.step) {
+            frameLanes.clear();
+            frameLanes.add(stepEnds[frame.step]);
+            frameLanes.setStart(stepStarts[frame.step]);
+            laneSteps[worker] = frame.step;
         }
+        frameLanes.evaluate(frame.t, frame.easedT);
+        ofxPresetsTrack::encodeRow(frameLanes, stepEnds[frame.step].bools, row);
+    };
+
+    // written next to the track and renamed over it once complete
+    const std::string temporaryPath = trackPath + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        ofLogError("ofxPresets::bakeSequence") << "Could not open " << temporaryPath;
+        return false;
+    }
 
-        // Reverse back the reversed ranges
-        if (std::stoi(rangeParts[0]) > std::stoi(rangeParts[1])) {
-            std::reverse(sr.begin(), sr.end());
+    std::vector<uint8_t> buffer;
+    ofxPresetsTrack::encodeHeader(schemaHash, fps, frames, state, buffer);
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+    const size_t rowSize = ofxPresetsTrack::rowSize(state);
+    const uint64_t batch = std::max<uint64_t>(threads, BAKE_BATCH_BYTES / std::max<size_t>(rowSize, 1));
+    for (uint64_t first = 0; written && first < frames; first += batch) {
+        const uint64_t count = std::min(batch, frames - first);
+        const uint64_t perThread = (count + threads - 1) / threads;
+        buffer.resize(count * rowSize);
+        prepareFrames(first, count);
+        std::fill(laneSteps.begin(), laneSteps.end(), stepEnds.size()); // the steps are numbered per batch
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 0; worker < threads && worker * perThread < count; ++worker) {
+            workers.emplace_back([&, worker]() {
+                const uint64_t end = std::min(count, (worker + 1) * perThread);
+                for (uint64_t frame = worker * perThread; frame < end; ++frame) {
+                    renderFrame(worker, batchFrames[frame], buffer.data() + frame * rowSize);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
         }
+        written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    }
+
+    written = ofxPresetsSafeFile::sync(file) && written;
+    written = std::fclose(file) == 0 && written;
+    std::error_code renameError;
+    if (written) {
+        std::filesystem::rename(temporaryPath, trackPath, renameError);
+    }
+    if (!written || renameError) {
+        ofLogError("ofxPresets::bakeSequence") << "Could not write " << trackPath;
+        std::remove(temporaryPath.c_str());
+        return false;
     }
 
-    return sr;
+    ofLog(OF_LOG_NOTICE) << "ofxPresets::bakeSequence:: " << frames << " frames at " << fps << " fps baked to " << trackPath;
+    return true;
 }
 
 
+/// <summary>
+/// Play a baked track: every update sets the parameters to the row of its frame, read from the memory mapped file.
+/// Nothing is decoded or interpolated while playing. Stops the sequence and the running transition
+/// </summary>
+/// <param name="loop">start over at the end, otherwise the last frame stays</param>
+/// <returns>false if the file is not a track baked with these parameters</returns>
+bool ofxPresets::playTrack(const std::string& trackPath, bool loop) {
+    std::string error;
+    if (!track.open(trackPath, schemaHash, bindingLanes, error)) {
+        ofLogError("ofxPresets::playTrack") << "Could not play " << trackPath << ": " << error;
+        trackPlaying = false; // a track that was playing is closed
+        return false;
+    }
+    stopInterpolating();
+    stopSequence();
+
+    trackLanes.clear();
+    trackLanes.add(track.layout());
+    trackLoop = loop;
+    trackStartTime = currentTime;
+    trackFrame = -1;
+    trackPlaying = true;
+    updateTrack();
+    return true;
+}
+
 
 /// <summary>
-/// Convert a range with ? into a vector of N times 0
-/// i.e. "?-3" = {0, 0, 0}
-/// i.e. "3-?" = {0, 0, 0}
-/// i.e. "?-?" = {0}
+/// Stop the track, the parameters keep the values of its last frame
 /// </summary>
-std::vector<int> ofxPresets::unfoldRandomRange(std::vector<std::string> randomRange) {
-    std::vector<int> sr;
+void ofxPresets::stopTrack() {
+    trackPlaying = false;
+    track.close();
+}
 
-    bool firstIsRandom = randomRange[0].find('?') != std::string::npos;
-    bool secondIsRandom = randomRange[1].find('?') != std::string::npos;
 
-    // when both are random, return a single 0
-    if (firstIsRandom && secondIsRandom) {
-        randomRange[1] = "1";
+/// <summary>
+/// Set the parameters to the frame of the track at the current time
+/// </summary>
+void ofxPresets::updateTrack() {
+    if (!trackPlaying) {
+        return;
+    }
+    if (track.schemaHash() != schemaHash) {
+        // the slots were checked by playTrack(), against parameters set up again since
+        ofLogError("ofxPresets::updateTrack") << "The parameters changed, the track stops";
+        stopTrack();
+        return;
+    }
+
+    const int64_t frames = static_cast<int64_t>(track.frames());
+    int64_t frame = static_cast<int64_t>(std::floor((currentTime - trackStartTime) * track.fps() + 1e-6)); // 1e-6: a frame time times the rate rounds down
+    frame = std::max<int64_t>(frame, 0);
+    bool ended = false;
+    if (frame >= frames) {
+        ended = !trackLoop;
+        frame = trackLoop ? frame % frames : frames - 1;
     }
-    // fill a range with N random presets
-    if (firstIsRandom || secondIsRandom) {
-        int rep = firstIsRandom ? std::stoi(randomRange[1]) : std::stoi(randomRange[0]);
-        for (int i = 1; i <= rep; ++i) {
-            sr.push_back(0);
+
+    if (frame != trackFrame) {
+        trackFrame = frame;
+        {
+            OFX_PRESETS_STATS_TIME(stats, Interpolate);
+            track.decodeRow(static_cast<uint64_t>(frame), trackLanes, trackBools);
         }
+        applyBoolValues(track.layout().bools.slots, trackBools.values.data());
+        applyLaneValues(trackLanes);
     }
 
-    return sr;
+    if (ended) {
+        stopTrack();
+    }
+}
+
+
+#pragma endregion
+
+
+
+
+#pragma region Listeners
+
+/// <summary>
+/// Event to notify that a preset has finished
+/// </summary>
+void ofxPresets::onPresetFinished() {
+    ofLogVerbose("ofxPresets::onPresetFinished") << "Sequence preset's waiting time finished";
+    ofNotifyEvent(sequencePresetFinished, this);
 }
 
 
 /// <summary>
-/// Removes invalid characters but digits, comma, dash, question mark, star
+/// Event to notify that a transition interpolation has finished, happens for direct preset apply and sequence transitions
 /// </summary>
-/// <param name="input"></param>
-/// <returns></returns>
-std::string ofxPresets::removeInvalidCharacters(const std::string& input) {
-    std::string result;
-    std::copy_if(input.begin(), input.end(), std::back_inserter(result), [](char c) {
-        return std::isdigit(c) || c == ',' || c == '-' || c == '?' || c == '*';
-        });
-    return result;
+void ofxPresets::onTransitionFinished() {
+    ofLogVerbose("ofxPresets::onTransitionFinished") << "Preset transition finished";
+    ofNotifyEvent(transitionFinished, this);
 }
 
 
-# pragma endregion
\ No newline at end of file
+/// <summary>
+/// NOT IN USE
+/// Event to notify that a transition has finished
+/// </summary>
+//void ofxPresets::onSequenceFinished() {
+//    ofLogVerbose("ofxPresets::onSequenceFinished") << "Sequence finished";
+//    ofNotifyEvent(sequenceFinished, this);
+//}
+
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,358 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofxPresetsBinary.h"
+
+
+/// <summary>
+/// Single file holding many presets
+///
+/// Layout: a fixed header, the preset payloads, and an index table (id, format, offset, size per preset)
+/// that the header points to. Payloads are the bytes of a json or binary preset file.
+///
+/// Saving appends the payload and a new index table, then rewrites the header offset in place,
+/// so until that last write the previous index is still the valid one.
+/// The replaced payloads and index tables are dead space, dropped by compact().
+/// Reads go through a memory mapping of the whole file. All methods are thread safe
+/// </summary>
+class ofxPresetsArchive {
+public:
+
+    static constexpr uint32_t version = 1;
+
+    enum Format : uint32_t {
+        Json = 0,
+        Binary = 1
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t indexOffset;
+        uint32_t indexCount;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        int32_t id;
+        uint32_t format;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    ofxPresetsArchive() = default;
+    ofxPresetsArchive(const ofxPresetsArchive&) = delete;
+    ofxPresetsArchive& operator=(const ofxPresetsArchive&) = delete;
+
+    /// <summary>
+    /// Open an archive file, an empty one is created if it does not exist
+    /// </summary>
+    /// <param name="error">reason when it fails</param>
+    bool open(const std::string& archivePath, std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+        entries.clear();
+        path = archivePath;
+
+        if (!std::filesystem::exists(path)) {
+            Header header = makeHeader(sizeof(Header), 0);
+            if (!ofxPresetsSafeFile::write(path, &header, sizeof(header), error)) {
+                path.clear();
+                return false;
+            }
+        }
+
+        if (!load(error)) {
+            unmap();
+            path.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+        entries.clear();
+        path.clear();
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !path.empty();
+    }
+
+    std::string getPath() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return path;
+    }
+
+    /// <summary>
+    /// Read the index again, for when the file was replaced outside this instance
+    /// </summary>
+    bool reload(std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path.empty()) {
+            error = "no archive open";
+            return false;
+        }
+        return load(error);
+    }
+
+    /// <summary>
+    /// Sorted ids of the stored presets
+    /// </summary>
+    std::vector<int> ids() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<int> result;
+        result.reserve(entries.size());
+        for (auto& [id, entry] : entries) {
+            result.push_back(id);
+        }
+        return result;
+    }
+
+    bool find(int id, Entry& entry) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return false;
+        }
+        entry = it->second;
+        return true;
+    }
+
+    /// <summary>
+    /// Call decode(const uint8_t* data, size_t size, uint32_t format) on the mapped payload of a preset,
+    /// without copying it. The archive stays locked during the call
+    /// </summary>
+    /// <returns>false if the preset is not stored, otherwise what decode returns</returns>
+    template<typename Decode>
+    bool visit(int id, Decode&& decode) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return false;
+        }
+        return decode(mapped.data() + it->second.offset, static_cast<size_t>(it->second.size), it->second.format);
+    }
+
+    /// <summary>
+    /// Copy the payload of a preset
+    /// </summary>
+    bool read(int id, std::vector<uint8_t>& bytes, uint32_t& format) const {
+        return visit(id, [&](const uint8_t* data, size_t size, uint32_t payloadFormat) {
+            bytes.assign(data, data + size);
+            format = payloadFormat;
+            return true;
+        });
+    }
+
+    struct Payload {
+        int id;
+        uint32_t format;
+        std::vector<uint8_t> bytes;
+    };
+
+    /// <summary>
+    /// Store a preset, replacing the previous payload of the same id
+    /// </summary>
+    bool put(int id, uint32_t format, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        return put({ Payload{ id, format, std::vector<uint8_t>(bytes, bytes + size) } });
+    }
+
+    /// <summary>
+    /// Store many presets with a single index update
+    /// </summary>
+    bool put(const std::vector<Payload>& payloads) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path.empty()) {
+            return false;
+        }
+
+        std::map<int, Entry> updated = entries;
+        std::vector<uint8_t> tail;
+        for (auto& payload : payloads) {
+            updated[payload.id] = Entry{ payload.id, payload.format, fileSize + tail.size(), static_cast<uint64_t>(payload.bytes.size()) };
+            tail.insert(tail.end(), payload.bytes.begin(), payload.bytes.end());
+        }
+        return append(tail, updated);
+    }
+
+    bool remove(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path.empty() || entries.find(id) == entries.end()) {
+            return false;
+        }
+
+        std::map<int, Entry> updated = entries;
+        updated.erase(id);
+
+        std::vector<uint8_t> tail;
+        return append(tail, updated);
+    }
+
+    /// <summary>
+    /// Bytes of replaced payloads and old index tables
+    /// </summary>
+    uint64_t deadBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fileSize - liveBytes();
+    }
+
+    /// <summary>
+    /// True when the dead space is worth a compact(): more than the live data, and at least minimumBytes
+    /// </summary>
+    bool needsCompaction(uint64_t minimumBytes = 256 * 1024) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t live = liveBytes();
+        uint64_t dead = fileSize - live;
+        return dead > live && dead >= minimumBytes;
+    }
+
+    /// <summary>
+    /// Rewrite the archive with only the current payloads,
+    /// into a temporary file that replaces the archive once complete
+    /// </summary>
+    bool compact(std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path.empty()) {
+            error = "no archive open";
+            return false;
+        }
+
+        std::vector<uint8_t> buffer(sizeof(Header));
+        std::map<int, Entry> compacted;
+        for (auto& [id, entry] : entries) {
+            Entry moved = entry;
+            moved.offset = buffer.size();
+            const uint8_t* payload = mapped.data() + entry.offset;
+            buffer.insert(buffer.end(), payload, payload + entry.size);
+            compacted[id] = moved;
+        }
+        uint64_t indexOffset = buffer.size();
+        appendIndex(buffer, compacted);
+        Header header = makeHeader(indexOffset, static_cast<uint32_t>(compacted.size()));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+
+        unmap(); // a mapped file can not be replaced on every platform
+        if (!ofxPresetsSafeFile::write(path, buffer.data(), buffer.size(), error)) {
+            std::string loadError;
+            load(loadError);
+            return false;
+        }
+        return load(error);
+    }
+
+private:
+    static Header makeHeader(uint64_t indexOffset, uint32_t indexCount) {
+        Header header;
+        std::memcpy(header.magic, "OFXA", 4);
+        header.version = version;
+        header.indexOffset = indexOffset;
+        header.indexCount = indexCount;
+        header.reserved = 0;
+        return header;
+    }
+
+    static void appendIndex(std::vector<uint8_t>& buffer, const std::map<int, Entry>& index) {
+        for (auto& [id, entry] : index) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entry);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(Entry));
+        }
+    }
+
+    uint64_t liveBytes() const {
+        uint64_t live = sizeof(Header) + entries.size() * sizeof(Entry);
+        for (auto& [id, entry] : entries) {
+            live += entry.size;
+        }
+        return live;
+    }
+
+    void unmap() {
+        mapped.close();
+        fileSize = 0;
+    }
+
+    /// <summary>
+    /// Map the file and read its index. Expects the mutex to be held
+    /// </summary>
+    bool load(std::string& error) {
+        unmap();
+        entries.clear();
+
+        if (!mapped.open(path)) {
+            error = "could not map the file";
+            return false;
+        }
+        fileSize = mapped.size();
+
+        Header header;
+        if (fileSize < sizeof(Header)) {
+            error = "file too short";
+            return false;
+        }
+        std::memcpy(&header, mapped.data(), sizeof(Header));
+        if (std::memcmp(header.magic, "OFXA", 4) != 0 || header.version != version) {
+            error = "not a preset archive of version " + std::to_string(version);
+            return false;
+        }
+        if (header.indexOffset > fileSize || header.indexCount > (fileSize - header.indexOffset) / sizeof(Entry)) {
+            error = "truncated index";
+            return false;
+        }
+
+        for (uint32_t i = 0; i < header.indexCount; ++i) {
+            Entry entry;
+            std::memcpy(&entry, mapped.data() + header.indexOffset + i * sizeof(Entry), sizeof(Entry));
+            if (entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+                error = "truncated payload for preset " + std::to_string(entry.id);
+                entries.clear();
+                return false;
+            }
+            entries[entry.id] = entry;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Append a payload (may be empty) and the new index, then point the header to it.
+    /// Both steps are synced to the disk, so the header never points to data that was not written. Expects the mutex to be held
+    /// </summary>
+    bool append(const std::vector<uint8_t>& payload, const std::map<int, Entry>& index) {
+        uint64_t indexOffset = fileSize + payload.size();
+        std::vector<uint8_t> tail = payload;
+        appendIndex(tail, index);
+        Header header = makeHeader(indexOffset, static_cast<uint32_t>(index.size()));
+
+        unmap();
+        bool written = false;
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        if (file != nullptr) {
+            written = std::fseek(file, 0, SEEK_END) == 0 &&
+                std::fwrite(tail.data(), 1, tail.size(), file) == tail.size() &&
+                ofxPresetsSafeFile::sync(file) &&
+                std::fseek(file, 0, SEEK_SET) == 0 &&
+                std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                ofxPresetsSafeFile::sync(file);
+            written = std::fclose(file) == 0 && written;
+        }
+
+        std::string error;
+        return load(error) && written;
+    }
+
+    mutable std::mutex mutex;
+    std::string path;
+    ofxPresetsMappedFile mapped;
+    uint64_t fileSize = 0;
+    std::map<int, Entry> entries;
+};
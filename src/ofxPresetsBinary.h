@@ -0,0 +1,423 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "ofxPresetsInterpolator.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/// <summary>
+/// Read-only memory mapping of a whole file
+/// </summary>
+class ofxPresetsMappedFile {
+public:
+    ofxPresetsMappedFile() = default;
+    ofxPresetsMappedFile(const ofxPresetsMappedFile&) = delete;
+    ofxPresetsMappedFile& operator=(const ofxPresetsMappedFile&) = delete;
+
+    ~ofxPresetsMappedFile() {
+        close();
+    }
+
+    /// <summary>
+    /// Map the file, fails on missing or empty files
+    /// </summary>
+    bool open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            return false;
+        }
+        bytes = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        bytes = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+        if (bytes == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<uint8_t*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    /// <summary>
+    /// Hint that the mapping is read front to back, so the system reads ahead of it
+    /// </summary>
+    void adviseSequential() {
+#if !defined(_WIN32)
+        if (bytes != nullptr) {
+            posix_madvise(const_cast<uint8_t*>(bytes), length, POSIX_MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+};
+
+
+/// <summary>
+/// Crash safe file writes
+/// </summary>
+class ofxPresetsSafeFile {
+public:
+
+    /// <summary>
+    /// Flush a stream down to the disk
+    /// </summary>
+    static bool sync(std::FILE* file) {
+        if (std::fflush(file) != 0) {
+            return false;
+        }
+#if defined(_WIN32)
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+    /// <summary>
+    /// Replace a file: the data is written to a temporary file next to it, synced to the disk,
+    /// and renamed over the target. Readers, and a crash, see either the previous file or the new one
+    /// </summary>
+    /// <param name="error">reason when it fails</param>
+    static bool write(const std::string& path, const void* data, size_t size, std::string& error) {
+        const std::string temporaryPath = path + ".tmp";
+
+        std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+        if (file == nullptr) {
+            error = "could not open " + temporaryPath;
+            return false;
+        }
+        bool written = std::fwrite(data, 1, size, file) == size && sync(file);
+        written = std::fclose(file) == 0 && written;
+        if (!written) {
+            error = "could not write " + temporaryPath;
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+        std::error_code renameError;
+        std::filesystem::rename(temporaryPath, path, renameError);
+        if (renameError) {
+            error = "could not replace " + path + ": " + renameError.message();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+#if !defined(_WIN32)
+        // make the rename itself durable
+        std::string folder = std::filesystem::path(path).parent_path().string();
+        int fd = ::open(folder.empty() ? "." : folder.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            ::close(fd);
+        }
+#endif
+        return true;
+    }
+};
+
+
+/// <summary>
+/// Binary preset format
+///
+/// A fixed header followed by one section per value type, each with the binding slots (uint32)
+/// and the packed values in slot order: bools as uint8, ints as int32, floats as float32,
+/// colors as four uint8 channels (r, g, b, a), doubles as float64, and the multi-component types
+/// (vec2, vec3, vec4, ofFloatColor, ofRectangle, quat) as float32 channels.
+/// Sections are padded to 4 bytes, data is little-endian.
+/// Files of older versions, without the sections added since, are still read.
+///
+/// The schema hash identifies the parameter layout the slots refer to,
+/// a file written with different parameters is rejected instead of applied to the wrong slots.
+/// The slots themselves are checked too, so a damaged file with a matching hash is rejected as well.
+/// </summary>
+class ofxPresetsBinary {
+public:
+
+    static constexpr uint32_t version = 3;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t schemaHash;
+        uint32_t bools;
+        uint32_t ints;
+        uint32_t floats;
+        uint32_t colors;
+        // version 2
+        uint32_t doubles;
+        uint32_t reserved;
+        // version 3
+        uint32_t vec2s;
+        uint32_t vec3s;
+        uint32_t vec4s;
+        uint32_t floatColors;
+        uint32_t rectangles;
+        uint32_t quats;
+    };
+
+    /// <summary>
+    /// Bytes of the header written by each version
+    /// </summary>
+    static size_t headerSize(uint32_t fileVersion) {
+        return fileVersion == 1 ? 32 : fileVersion == 2 ? 40 : sizeof(Header);
+    }
+
+    static bool hasMagic(const Header& header) {
+        return std::memcmp(header.magic, "OFXP", 4) == 0;
+    }
+
+    /// <summary>
+    /// 64 bits FNV-1a, to hash the schema
+    /// </summary>
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t h = seed;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    /// <summary>
+    /// Write a preset, see ofxPresetsSafeFile::write. Values are sorted by slot
+    /// </summary>
+    /// <returns>false if the file could not be written</returns>
+    static bool write(const std::string& path, uint64_t schemaHash, const ofxPresetsTargetSet& targets, std::string& error) {
+        std::vector<uint8_t> buffer;
+        encode(schemaHash, targets, buffer);
+        return ofxPresetsSafeFile::write(path, buffer.data(), buffer.size(), error);
+    }
+
+    /// <summary>
+    /// Serialize a preset into a buffer. Values are sorted by slot
+    /// </summary>
+    static void encode(uint64_t schemaHash, const ofxPresetsTargetSet& targets, std::vector<uint8_t>& buffer) {
+        Header header;
+        std::memcpy(header.magic, "OFXP", 4);
+        header.version = version;
+        header.schemaHash = schemaHash;
+        header.bools = static_cast<uint32_t>(targets.bools.size());
+        header.ints = static_cast<uint32_t>(targets.ints.size());
+        header.floats = static_cast<uint32_t>(targets.floats.size());
+        header.colors = static_cast<uint32_t>(targets.colors.size());
+        header.doubles = static_cast<uint32_t>(targets.doubles.size());
+        header.reserved = 0;
+        header.vec2s = static_cast<uint32_t>(targets.vec2s.size());
+        header.vec3s = static_cast<uint32_t>(targets.vec3s.size());
+        header.vec4s = static_cast<uint32_t>(targets.vec4s.size());
+        header.floatColors = static_cast<uint32_t>(targets.floatColors.size());
+        header.rectangles = static_cast<uint32_t>(targets.rectangles.size());
+        header.quats = static_cast<uint32_t>(targets.quats.size());
+
+        buffer.clear();
+        append(buffer, &header, sizeof(header));
+
+        writeSection<uint8_t>(buffer, targets.bools);
+        writeSection<int32_t>(buffer, targets.ints);
+        writeSection<float>(buffer, targets.floats);
+        writeSection<uint8_t>(buffer, targets.colors);
+        writeSection<double>(buffer, targets.doubles);
+        writeSection<float>(buffer, targets.vec2s);
+        writeSection<float>(buffer, targets.vec3s);
+        writeSection<float>(buffer, targets.vec4s);
+        writeSection<float>(buffer, targets.floatColors);
+        writeSection<float>(buffer, targets.rectangles);
+        writeSection<float>(buffer, targets.quats);
+    }
+
+    /// <summary>
+    /// Read a memory mapped preset
+    /// </summary>
+    /// <param name="slotLanes">lane of each slot of the schema, see ofxPresetsTargetSet::matches</param>
+    /// <param name="error">reason when it fails</param>
+    /// <returns>false if the file is not a valid preset for this schema</returns>
+    static bool read(const std::string& path, uint64_t schemaHash, const std::vector<uint8_t>& slotLanes, ofxPresetsTargetSet& targets, std::string& error) {
+        ofxPresetsMappedFile file;
+        if (!file.open(path)) {
+            error = "could not map the file";
+            return false;
+        }
+        return decode(file.data(), file.size(), schemaHash, slotLanes, targets, error);
+    }
+
+    /// <summary>
+    /// Decode a preset from memory
+    /// </summary>
+    /// <param name="slotLanes">lane of each slot of the schema, see ofxPresetsTargetSet::matches</param>
+    static bool decode(const uint8_t* data, size_t size, uint64_t schemaHash, const std::vector<uint8_t>& slotLanes, ofxPresetsTargetSet& targets, std::string& error) {
+        targets.clear();
+
+        Header header = {};
+        if (size < headerSize(1)) {
+            error = "file too short";
+            return false;
+        }
+        std::memcpy(&header, data, headerSize(1));
+        if (!hasMagic(header) || header.version < 1 || header.version > version) {
+            error = "not a preset file of version " + std::to_string(version) + " or older";
+            return false;
+        }
+        const size_t fileHeaderSize = headerSize(header.version);
+        if (size < fileHeaderSize) {
+            error = "file too short";
+            return false;
+        }
+        std::memcpy(&header, data, fileHeaderSize);
+        if (header.schemaHash != schemaHash) {
+            error = "saved with different parameters";
+            return false;
+        }
+
+        size_t offset = fileHeaderSize;
+        if (!readSection<uint8_t>(data, size, offset, header.bools, targets.bools) ||
+            !readSection<int32_t>(data, size, offset, header.ints, targets.ints) ||
+            !readSection<float>(data, size, offset, header.floats, targets.floats) ||
+            !readSection<uint8_t>(data, size, offset, header.colors, targets.colors) ||
+            !readSection<double>(data, size, offset, header.doubles, targets.doubles) ||
+            !readSection<float>(data, size, offset, header.vec2s, targets.vec2s) ||
+            !readSection<float>(data, size, offset, header.vec3s, targets.vec3s) ||
+            !readSection<float>(data, size, offset, header.vec4s, targets.vec4s) ||
+            !readSection<float>(data, size, offset, header.floatColors, targets.floatColors) ||
+            !readSection<float>(data, size, offset, header.rectangles, targets.rectangles) ||
+            !readSection<float>(data, size, offset, header.quats, targets.quats)) {
+            targets.clear();
+            error = "truncated file";
+            return false;
+        }
+        if (!targets.matches(slotLanes)) {
+            targets.clear();
+            error = "slots do not match the parameters";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void append(std::vector<uint8_t>& buffer, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    static size_t padding(size_t size) {
+        return (4 - size % 4) % 4;
+    }
+
+    template<typename Packed, typename T>
+    static void writeSection(std::vector<uint8_t>& buffer, const ofxPresetsTargetSet::Lane<T>& lane) {
+        // slot order
+        std::vector<size_t> order(lane.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&lane](size_t a, size_t b) { return lane.slots[a] < lane.slots[b]; });
+
+        for (size_t i : order) {
+            append(buffer, &lane.slots[i], sizeof(uint32_t));
+        }
+
+        size_t valuesSize = 0;
+        for (size_t i : order) {
+            for (size_t c = 0; c < lane.channels; ++c) {
+                Packed value = static_cast<Packed>(lane.values[i * lane.channels + c]);
+                append(buffer, &value, sizeof(Packed));
+                valuesSize += sizeof(Packed);
+            }
+        }
+        buffer.resize(buffer.size() + padding(valuesSize), 0);
+    }
+
+    template<typename Packed, typename T>
+    static bool readSection(const uint8_t* data, size_t size, size_t& offset, uint32_t count, ofxPresetsTargetSet::Lane<T>& lane) {
+        const size_t slotsSize = count * sizeof(uint32_t);
+        const size_t valuesSize = count * lane.channels * sizeof(Packed);
+        if (offset + slotsSize + valuesSize > size) {
+            return false;
+        }
+
+        lane.slots.resize(count);
+        std::memcpy(lane.slots.data(), data + offset, slotsSize);
+        offset += slotsSize;
+
+        lane.values.resize(count * lane.channels);
+        if (std::is_same<Packed, T>::value) {
+            std::memcpy(lane.values.data(), data + offset, valuesSize);
+        }
+        else {
+            for (size_t i = 0; i < lane.values.size(); ++i) {
+                Packed value;
+                std::memcpy(&value, data + offset + i * sizeof(Packed), sizeof(Packed));
+                lane.values[i] = static_cast<T>(value);
+            }
+        }
+        offset += valuesSize + padding(valuesSize);
+        return true;
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "ofxPresetsInterpolator.h"
+
+/// <summary>
+/// N-way weighted blend of presets
+///
+/// The K presets are resolved once to the same slots in the same order: each lane of `sources` holds
+/// K blocks of values one after the other. A preset without a slot that another preset has takes the value
+/// the parameter had when the blend was built. A blend is then one weighted sum per lane, written to the
+/// value arrays of `output`. Colors are stored and summed in the color space the blend was built for,
+/// quaternions are summed after aligning their signs and normalized
+/// </summary>
+class ofxPresetsBlend {
+public:
+    std::vector<int> ids;          // presets of the blend, in the order of the weights
+    ofxPresetsTargetSet sources;   // K blocks of values per lane
+    ofxPresetsInterpolator output; // slots of the blend, value holds the blended values
+    ofxPresetsColorSpace colorSpace = ofxPresetsColorSpace::RGB;
+    bool valid = false;
+
+    size_t count() const { return ids.size(); }
+
+    bool uses(int id) const {
+        return valid && std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    void invalidate() {
+        valid = false;
+    }
+
+    /// <summary>
+    /// Resolve the presets to the same slots
+    /// </summary>
+    /// <param name="presets">decoded values of each preset</param>
+    /// <param name="current">values of all parameters, for the slots a preset does not have</param>
+    /// <param name="slotCount">size of the binding table</param>
+    void build(const std::vector<int>& presetIds, const std::vector<ofxPresetsTargetSet>& presets,
+        const ofxPresetsTargetSet& current, size_t slotCount, ofxPresetsColorSpace space) {
+        ids = presetIds;
+        colorSpace = space;
+        const size_t k = presets.size();
+
+        // the slots any of the presets has
+        std::vector<uint8_t> used(slotCount, 0);
+        for (const auto& preset : presets) {
+            ofxPresetsTargetSet::forEachLane([&used](const auto& lane) {
+                for (uint32_t slot : lane.slots) {
+                    used[slot] = 1;
+                }
+            }, preset);
+        }
+
+        // current values of those slots, in slot order
+        std::vector<uint32_t> position(slotCount, 0);
+        sources.clear();
+        ofxPresetsTargetSet::forEachLane([&used, &position](auto& out, const auto& in) {
+            for (size_t i = 0; i < in.size(); ++i) {
+                uint32_t slot = in.slots[i];
+                if (used[slot]) {
+                    position[slot] = static_cast<uint32_t>(out.size());
+                    out.add(slot, &in.values[i * in.channels]);
+                }
+            }
+        }, sources, current);
+
+        output.clear();
+        output.add(sources);
+
+        // one block per preset, starting as the current values
+        ofxPresetsTargetSet::forEachLane([k](auto& lane) {
+            const size_t block = lane.values.size();
+            lane.values.resize(block * k);
+            for (size_t j = 1; j < k; ++j) {
+                std::copy(lane.values.begin(), lane.values.begin() + block, lane.values.begin() + j * block);
+            }
+        }, sources);
+
+        for (size_t j = 0; j < k; ++j) {
+            ofxPresetsTargetSet::forEachLane([j, &position](auto& out, const auto& in) {
+                const size_t block = out.size() * out.channels;
+                for (size_t i = 0; i < in.size(); ++i) {
+                    auto values = in.values.begin() + i * in.channels;
+                    std::copy(values, values + in.channels, out.values.begin() + j * block + position[in.slots[i]] * out.channels);
+                }
+            }, sources, presets[j]);
+        }
+
+        if (colorSpace == ofxPresetsColorSpace::OKLab) {
+            ofxPresetsColor::toOKLab(sources.colors.values.data(), sources.colors.values.data(), k * sources.colors.size(), 255.0f);
+            ofxPresetsColor::toOKLab(sources.floatColors.values.data(), sources.floatColors.values.data(), k * sources.floatColors.size(), 1.0f);
+        }
+        alignQuaternions();
+
+        valid = true;
+    }
+
+    /// <summary>
+    /// Weighted sum of the sources into the output values
+    /// </summary>
+    /// <param name="weights">one per preset, summing to 1</param>
+    void evaluate(const float* weights) {
+        blendLane(sources.ints, weights, output.ints.value.data());
+        blendLane(sources.floats, weights, output.floats.value.data());
+        blendLane(sources.doubles, weights, output.doubles.value.data());
+        blendColors(sources.colors, weights, output.colors.value.data(), 255.0f);
+        blendColors(sources.floatColors, weights, output.floatColors.value.data(), 1.0f);
+        blendLane(sources.vec2s, weights, output.vec2s.value.data());
+        blendLane(sources.vec3s, weights, output.vec3s.value.data());
+        blendLane(sources.vec4s, weights, output.vec4s.value.data());
+        blendLane(sources.rectangles, weights, output.rectangles.value.data());
+        blendLane(sources.quats, weights, output.quats.value.data());
+        normalizeQuaternions(output.quats.value.data(), output.quats.size());
+    }
+
+    /// <summary>
+    /// Bools can not be summed, they take the values of the preset with the largest weight
+    /// </summary>
+    /// <returns>the bool values, in the order of sources.bools.slots</returns>
+    const uint8_t* dominantBools(const float* weights) const {
+        size_t dominant = std::max_element(weights, weights + count()) - weights;
+        return sources.bools.values.data() + dominant * sources.bools.size();
+    }
+
+private:
+    std::vector<float> labValues; // blended colors in OKLab, before the conversion back
+
+    template<typename T>
+    void blendLane(const ofxPresetsTargetSet::Lane<T>& lane, const float* weights, T* out) {
+        const size_t block = lane.size() * lane.channels;
+        ofxSEeasing::blend(lane.values.data(), block, weights, count(), out, block);
+    }
+
+    void blendColors(const ofxPresetsTargetSet::Lane<float>& lane, const float* weights, float* out, float scale) {
+        if (colorSpace == ofxPresetsColorSpace::RGB) {
+            blendLane(lane, weights, out);
+            return;
+        }
+        labValues.resize(lane.size() * lane.channels);
+        blendLane(lane, weights, labValues.data());
+        ofxPresetsColor::fromOKLab(labValues.data(), out, lane.size(), scale);
+    }
+
+    /// <summary>
+    /// q and -q are the same rotation, flip the quaternions of each preset to the side of the first preset
+    /// so the sum does not cancel out
+    /// </summary>
+    void alignQuaternions() {
+        auto& quats = sources.quats;
+        const size_t block = quats.size() * 4;
+        for (size_t j = 1; j < count(); ++j) {
+            for (size_t i = 0; i < block; i += 4) {
+                const float* a = &quats.values[i];
+                float* b = &quats.values[j * block + i];
+                if (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f) {
+                    for (size_t c = 0; c < 4; ++c) {
+                        b[c] = -b[c];
+                    }
+                }
+            }
+        }
+    }
+
+    static void normalizeQuaternions(float* q, size_t n) {
+        for (size_t i = 0; i < n * 4; i += 4) {
+            float length = std::sqrt(q[i] * q[i] + q[i + 1] * q[i + 1] + q[i + 2] * q[i + 2] + q[i + 3] * q[i + 3]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            for (size_t c = 0; c < 4; ++c) {
+                q[i + c] *= scale;
+            }
+        }
+    }
+};
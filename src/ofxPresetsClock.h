@@ -0,0 +1,37 @@
+#pragma once
+#include "ofUtils.h"
+
+/// <summary>
+/// Time source of the preset manager, in seconds
+/// </summary>
+class ofxPresetsClock {
+public:
+    virtual ~ofxPresetsClock() = default;
+    virtual double now() = 0;
+};
+
+
+/// <summary>
+/// The openFrameworks elapsed time, in double precision. Default clock
+/// </summary>
+class ofxPresetsElapsedClock : public ofxPresetsClock {
+public:
+    double now() override {
+        return ofGetElapsedTimeMicros() * 1e-6;
+    }
+};
+
+
+/// <summary>
+/// A clock moved by hand, to step at a fixed rate or faster than real time (offline renders, tests)
+/// </summary>
+class ofxPresetsManualClock : public ofxPresetsClock {
+public:
+    double now() override { return time; }
+
+    void set(double seconds) { time = seconds; }
+    void advance(double seconds) { time += seconds; }
+
+private:
+    double time = 0.0;
+};
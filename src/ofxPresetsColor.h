@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "ofxSEasing.h"
+
+// Color space the color parameters are interpolated in
+enum class ofxPresetsColorSpace {
+    RGB,   // straight sRGB channels, the default
+    OKLab  // perceptual, even steps in lightness and hue, no grey dip between complementary colors
+};
+
+
+/// <summary>
+/// Batched sRGB to OKLab conversions (B. Ottosson's OKLab) for interleaved r, g, b, a channels.
+///
+/// The sRGB transfer curve goes through precomputed tables with linear interpolation between entries,
+/// so a conversion back to sRGB is two small matrix products, three cubes and three table reads per color, without branches.
+/// Alpha is copied as is
+/// </summary>
+class ofxPresetsColor {
+public:
+
+    /// <summary>
+    /// sRGB channel to linear light, both between 0 and 1
+    /// </summary>
+    static float toLinear(float v) {
+        return lookup(tables().linear, v);
+    }
+
+    /// <summary>
+    /// Linear light to sRGB channel, both between 0 and 1
+    /// </summary>
+    static float toSrgb(float v) {
+        return lookup(tables().srgb, v);
+    }
+
+    /// <summary>
+    /// n colors from sRGB (channels from 0 to scale) to OKLab, alpha stays in the fourth channel
+    /// </summary>
+    static void toOKLab(const float* rgba, float* lab, size_t n, float scale) {
+        const float* table = tables().linear;
+        const float inverseScale = 1.0f / scale;
+        for (size_t i = 0; i < n * 4; i += 4) {
+            float r = lookup(table, rgba[i] * inverseScale);
+            float g = lookup(table, rgba[i + 1] * inverseScale);
+            float b = lookup(table, rgba[i + 2] * inverseScale);
+
+            float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+            float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+            float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+            lab[i] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+            lab[i + 1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+            lab[i + 2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+            lab[i + 3] = rgba[i + 3];
+        }
+    }
+
+    /// <summary>
+    /// n colors from OKLab back to sRGB (channels from 0 to scale), out of gamut channels are clamped
+    /// </summary>
+    static void fromOKLab(const float* lab, float* rgba, size_t n, float scale) {
+        const float* table = tables().srgb;
+        size_t i = 0;
+#if defined(OFX_SEASING_SSE)
+        // four colors at a time, transposed to one register per channel
+        using Float4 = ofxSEeasing::Float4;
+        for (; i + 16 <= n * 4; i += 16) {
+            __m128 c0 = _mm_loadu_ps(lab + i);
+            __m128 c1 = _mm_loadu_ps(lab + i + 4);
+            __m128 c2 = _mm_loadu_ps(lab + i + 8);
+            __m128 c3 = _mm_loadu_ps(lab + i + 12);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            Float4 L = c0, a = c1, b = c2;
+
+            Float4 l = L + Float4(0.3963377774f) * a + Float4(0.2158037573f) * b;
+            Float4 m = L - Float4(0.1055613458f) * a - Float4(0.0638541728f) * b;
+            Float4 s = L - Float4(0.0894841775f) * a - Float4(1.2914855480f) * b;
+            l = l * l * l;
+            m = m * m * m;
+            s = s * s * s;
+
+            Float4 r = lookup(table, Float4(4.0767416621f) * l - Float4(3.3077115913f) * m + Float4(0.2309699292f) * s) * Float4(scale);
+            Float4 g = lookup(table, Float4(-1.2684380046f) * l + Float4(2.6097574011f) * m - Float4(0.3413193965f) * s) * Float4(scale);
+            Float4 bl = lookup(table, Float4(-0.0041960863f) * l - Float4(0.7034186147f) * m + Float4(1.7076147010f) * s) * Float4(scale);
+
+            __m128 o0 = r.v, o1 = g.v, o2 = bl.v, o3 = c3;
+            _MM_TRANSPOSE4_PS(o0, o1, o2, o3);
+            _mm_storeu_ps(rgba + i, o0);
+            _mm_storeu_ps(rgba + i + 4, o1);
+            _mm_storeu_ps(rgba + i + 8, o2);
+            _mm_storeu_ps(rgba + i + 12, o3);
+        }
+#endif
+        for (; i < n * 4; i += 4) {
+            float l = lab[i] + 0.3963377774f * lab[i + 1] + 0.2158037573f * lab[i + 2];
+            float m = lab[i] - 0.1055613458f * lab[i + 1] - 0.0638541728f * lab[i + 2];
+            float s = lab[i] - 0.0894841775f * lab[i + 1] - 1.2914855480f * lab[i + 2];
+            l = l * l * l;
+            m = m * m * m;
+            s = s * s * s;
+
+            rgba[i] = lookup(table, 4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s) * scale;
+            rgba[i + 1] = lookup(table, -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s) * scale;
+            rgba[i + 2] = lookup(table, -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s) * scale;
+            rgba[i + 3] = lab[i + 3];
+        }
+    }
+
+    /// <summary>
+    /// Random change of one sRGB color (channels from 0 to scale) in OKLCh:
+    /// lightness, chroma and hue are moved by the given amounts, each one a fraction of its full range
+    /// </summary>
+    static void shift(float* rgba, float scale, float lightness, float chroma, float hue) {
+        float lab[4];
+        toOKLab(rgba, lab, 1, scale);
+        float c = std::sqrt(lab[1] * lab[1] + lab[2] * lab[2]);
+        float h = std::atan2(lab[2], lab[1]);
+        lab[0] = std::clamp(lab[0] + lightness, 0.0f, 1.0f);
+        c = std::max(c + chroma * maxChroma, 0.0f);
+        h += hue * 2.0f * pi;
+        lab[1] = c * std::cos(h);
+        lab[2] = c * std::sin(h);
+        fromOKLab(lab, rgba, 1, scale);
+    }
+
+private:
+    static constexpr size_t tableSize = 4096;
+    static constexpr float maxChroma = 0.33f; // about the most saturated sRGB color
+    static constexpr float pi = 3.14159265358979f;
+
+    struct Tables {
+        float linear[tableSize + 1];
+        float srgb[tableSize + 1];
+
+        Tables() {
+            for (size_t i = 0; i <= tableSize; ++i) {
+                double v = static_cast<double>(i) / tableSize;
+                linear[i] = static_cast<float>(v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4));
+                srgb[i] = static_cast<float>(v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055);
+            }
+        }
+    };
+
+    static const Tables& tables() {
+        static const Tables instance;
+        return instance;
+    }
+
+    static float lookup(const float* table, float v) {
+        float position = std::min(std::max(v, 0.0f), 1.0f) * tableSize;
+        int index = std::min(static_cast<int>(position), static_cast<int>(tableSize) - 1); // 1 is in the last segment
+        float fraction = position - static_cast<float>(index);
+        return table[index] + (table[index + 1] - table[index]) * fraction;
+    }
+
+#if defined(OFX_SEASING_SSE)
+    static ofxSEeasing::Float4 lookup(const float* table, ofxSEeasing::Float4 v) {
+        __m128 position = _mm_mul_ps(_mm_min_ps(_mm_max_ps(v.v, _mm_setzero_ps()), _mm_set1_ps(1.0f)), _mm_set1_ps(static_cast<float>(tableSize)));
+        __m128i index = _mm_cvttps_epi32(_mm_min_ps(position, _mm_set1_ps(static_cast<float>(tableSize - 1))));
+        __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+        alignas(16) int32_t i[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+        __m128 low = _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+        __m128 high = _mm_setr_ps(table[i[0] + 1], table[i[1] + 1], table[i[2] + 1], table[i[3] + 1]);
+        return _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), fraction));
+    }
+#endif
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/// <summary>
+/// Bounded lock-free queue, many producer threads and a single consumer thread
+///
+/// A ring of cells, each with a sequence number telling whether it is free for the producer
+/// of that lap or filled for the consumer (D. Vyukov's bounded queue).
+/// Producers claim a cell with a compare-and-swap on the tail, the consumer owns the head.
+/// Neither side ever blocks: push() fails when the ring is full, pop() when it is empty
+/// </summary>
+template<typename T>
+class ofxPresetsCommandQueue {
+public:
+    /// <param name="capacity">rounded up to a power of two</param>
+    explicit ofxPresetsCommandQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ofxPresetsCommandQueue(const ofxPresetsCommandQueue&) = delete;
+    ofxPresetsCommandQueue& operator=(const ofxPresetsCommandQueue&) = delete;
+
+    /// <summary>
+    /// Add an item, from any thread
+    /// </summary>
+    /// <returns>false if the queue is full</returns>
+    bool push(T&& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                // free for this lap, claim it
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                return false; // still holds the item of the previous lap
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed); // claimed by another producer
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// Take the oldest item, only from the consumer thread
+    /// </summary>
+    /// <returns>false if the queue is empty</returns>
+    bool pop(T& value) {
+        Cell& cell = cells[head & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(head + 1) < 0) {
+            return false; // not filled yet
+        }
+        value = std::move(cell.value);
+        cell.sequence.store(head + mask + 1, std::memory_order_release); // free for the next lap
+        ++head;
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{ 0 }; // producers
+    alignas(64) size_t head = 0;               // consumer
+};
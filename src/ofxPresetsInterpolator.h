@@ -0,0 +1,453 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "ofxSEasing.h"
+#include "ofxPresetsColor.h"
+
+/// <summary>
+/// Decoded preset values, already resolved to binding slots.
+/// Same layout as the interpolator lanes, so applying one is a plain copy.
+/// Each lane keeps the type of its parameters: ints are exact, doubles keep their precision
+/// </summary>
+struct ofxPresetsTargetSet {
+
+    template<typename T>
+    struct Lane {
+        using Value = T;
+
+        size_t channels = 1;
+        std::vector<uint32_t> slots;
+        std::vector<T> values;  // `channels` values per slot
+
+        size_t size() const { return slots.size(); }
+
+        void clear() {
+            slots.clear();
+            values.clear();
+        }
+
+        void add(size_t slot, const T* slotValues) {
+            slots.push_back(static_cast<uint32_t>(slot));
+            values.insert(values.end(), slotValues, slotValues + channels);
+        }
+    };
+
+    Lane<uint8_t> bools;
+    Lane<int64_t> ints;
+    Lane<float> floats;
+    Lane<double> doubles;
+    Lane<float> colors; // r, g, b, a channels, 0 to 255
+    // multi-component types, channels in the order of ofxPresetsVectorType
+    Lane<float> vec2s;
+    Lane<float> vec3s;
+    Lane<float> vec4s;
+    Lane<float> floatColors;
+    Lane<float> rectangles;
+    Lane<float> quats;
+
+    ofxPresetsTargetSet() {
+        colors.channels = 4;
+        vec2s.channels = 2;
+        vec3s.channels = 3;
+        vec4s.channels = 4;
+        floatColors.channels = 4;
+        rectangles.channels = 4;
+        quats.channels = 4;
+    }
+
+    void clear() {
+        bools.clear();
+        ints.clear();
+        floats.clear();
+        doubles.clear();
+        colors.clear();
+        vec2s.clear();
+        vec3s.clear();
+        vec4s.clear();
+        floatColors.clear();
+        rectangles.clear();
+        quats.clear();
+    }
+
+    /// <summary>
+    /// Call a function with the matching lanes of one or more target sets:
+    /// forEachLane(f, a, b) calls f(a.bools, b.bools), f(a.ints, b.ints) and so on
+    /// </summary>
+    template<typename Function, typename... Sets>
+    static void forEachLane(Function function, Sets&... sets) {
+        function(sets.bools...);
+        function(sets.ints...);
+        function(sets.floats...);
+        function(sets.doubles...);
+        function(sets.colors...);
+        function(sets.vec2s...);
+        function(sets.vec3s...);
+        function(sets.vec4s...);
+        function(sets.floatColors...);
+        function(sets.rectangles...);
+        function(sets.quats...);
+    }
+
+    bool empty() const {
+        return bools.size() == 0 && ints.size() == 0 && floats.size() == 0 && doubles.size() == 0 && colors.size() == 0 &&
+            vec2s.size() == 0 && vec3s.size() == 0 && vec4s.size() == 0 && floatColors.size() == 0 && rectangles.size() == 0 && quats.size() == 0;
+    }
+
+    /// <summary>
+    /// Check slots read from a file before they index the binding table: each slot must exist and be in the lane of its type
+    /// </summary>
+    /// <param name="slotLanes">lane of each slot of the table, lanes numbered in the order of forEachLane</param>
+    bool matches(const std::vector<uint8_t>& slotLanes) const {
+        uint8_t lane = 0;
+        bool valid = true;
+        forEachLane([&](const auto& target) {
+            for (uint32_t slot : target.slots) {
+                valid = valid && slot < slotLanes.size() && slotLanes[slot] == lane;
+            }
+            ++lane;
+        }, *this);
+        return valid;
+    }
+};
+
+
+/// <summary>
+/// Structure-of-arrays interpolation engine
+///
+/// Start values, target values and binding slots are kept in flat parallel arrays,
+/// one lane per value type, so a frame update is a linear sweep over each lane.
+/// Lanes store their own type (int64, float, double), so there is no conversion on the per-frame path.
+/// Colors and the multi-component types (vectors, rectangles, quaternions) are stored as interleaved channels,
+/// so each lane is still a single sweep. Quaternions are slerped, everything else is lerped.
+/// With the OKLab color space the colors are blended in OKLab: the ends are converted once per transition,
+/// and each frame converts the blended values back to sRGB.
+/// </summary>
+class ofxPresetsInterpolator {
+public:
+
+    /// <summary>
+    /// Parallel arrays for one value type.
+    /// `slots` has one entry per parameter, the value arrays have `channels` entries per parameter
+    /// </summary>
+    template<typename T>
+    struct Lane {
+        size_t channels = 1;
+        std::vector<uint32_t> slots;
+        std::vector<T> start;
+        std::vector<T> target;
+        std::vector<T> value;
+        std::vector<T> back; // values computed ahead on a worker thread, see swapBuffers(). Sized on first use
+        std::vector<T> inFlight; // values of the interrupted transition, see begin()
+
+        size_t size() const { return slots.size(); }
+
+        void clear() {
+            slots.clear();
+            start.clear();
+            target.clear();
+            value.clear();
+            back.clear();
+        }
+
+        /// <summary>
+        /// Queue a slot, its start values are filled later
+        /// </summary>
+        /// <param name="targetValues">`channels` values</param>
+        void add(size_t slot, const T* targetValues) {
+            slots.push_back(static_cast<uint32_t>(slot));
+            for (size_t c = 0; c < channels; ++c) {
+                start.push_back(T());
+                target.push_back(targetValues[c]);
+                value.push_back(T());
+            }
+        }
+
+        /// <summary>
+        /// Queue all slots of a decoded lane, start values are filled later
+        /// </summary>
+        void add(const ofxPresetsTargetSet::Lane<T>& lane) {
+            slots.insert(slots.end(), lane.slots.begin(), lane.slots.end());
+            target.insert(target.end(), lane.values.begin(), lane.values.end());
+            start.resize(target.size(), T());
+            value.resize(target.size(), T());
+        }
+
+        /// <summary>
+        /// value = start + (target - start) * amount, for every channel of every slot
+        /// </summary>
+        /// <param name="toBack">write to the back buffer instead of the values</param>
+        void evaluate(float amount, bool toBack = false) {
+            ofxSEeasing::lerp(start.data(), target.data(), amount, output(toBack), target.size());
+        }
+
+        T* output(bool toBack) {
+            if (!toBack) {
+                return value.data();
+            }
+            back.resize(target.size());
+            return back.data();
+        }
+
+        size_t memoryFootprint() const {
+            return slots.capacity() * sizeof(uint32_t) + (start.capacity() + target.capacity() + value.capacity() + back.capacity() + inFlight.capacity()) * sizeof(T);
+        }
+    };
+
+    Lane<int64_t> ints;
+    Lane<float> floats;
+    Lane<double> doubles;
+    Lane<float> colors;
+    Lane<float> vec2s;
+    Lane<float> vec3s;
+    Lane<float> vec4s;
+    Lane<float> floatColors;
+    Lane<float> rectangles;
+    Lane<float> quats; // w, x, y, z
+
+    double startTime = 0.0;
+    ofxPresetsColorSpace colorSpace = ofxPresetsColorSpace::RGB;
+
+    ofxPresetsInterpolator() {
+        colors.channels = 4;
+        vec2s.channels = 2;
+        vec3s.channels = 3;
+        vec4s.channels = 4;
+        floatColors.channels = 4;
+        rectangles.channels = 4;
+        quats.channels = 4;
+    }
+
+    /// <summary>
+    /// Drop any queued targets and start a new transition.
+    /// When a transition is interrupted its current values are kept, so the slots of the new one can start
+    /// where they are instead of where their parameters were last set, see startFromInFlight()
+    /// </summary>
+    void begin(double time) {
+        ++generation;
+        if (active) {
+            forEachLane([this](auto& lane) {
+                // before the first evaluation the values are still the start ones
+                lane.inFlight.swap(evaluated ? lane.value : lane.start);
+                for (size_t i = 0; i < lane.size(); ++i) {
+                    uint32_t slot = lane.slots[i];
+                    if (slot >= inFlightIndex.size()) {
+                        inFlightIndex.resize(slot + 1, 0);
+                        inFlightGeneration.resize(slot + 1, 0);
+                    }
+                    inFlightIndex[slot] = static_cast<uint32_t>(i);
+                    inFlightGeneration[slot] = generation;
+                }
+            });
+        }
+        clear();
+        colorsChanged();
+        startTime = time;
+        active = true;
+    }
+
+    /// <summary>
+    /// Drop all targets and stop interpolating
+    /// </summary>
+    void clear() {
+        ints.clear();
+        floats.clear();
+        doubles.clear();
+        colors.clear();
+        vec2s.clear();
+        vec3s.clear();
+        vec4s.clear();
+        floatColors.clear();
+        rectangles.clear();
+        quats.clear();
+        active = false;
+        evaluated = false;
+    }
+
+    bool isActive() const { return active; }
+    uint32_t getGeneration() const { return generation; } // changes with every begin()
+
+    /// <summary>
+    /// Start values of a slot from the transition interrupted by begin(), if it was moving that slot
+    /// </summary>
+    /// <param name="i">index of the slot in the lane</param>
+    /// <returns>false if the slot was not in flight, its start value has to be read from the parameter</returns>
+    template<typename T>
+    bool startFromInFlight(Lane<T>& lane, size_t i) const {
+        uint32_t slot = lane.slots[i];
+        if (slot >= inFlightGeneration.size() || inFlightGeneration[slot] != generation) {
+            return false;
+        }
+        const T* values = &lane.inFlight[inFlightIndex[slot] * lane.channels];
+        std::copy(values, values + lane.channels, &lane.start[i * lane.channels]);
+        return true;
+    }
+
+    /// <summary>
+    /// The start or target colors were changed, convert them again before the next evaluation
+    /// </summary>
+    void colorsChanged() {
+        colorLab.stale = true;
+        floatColorLab.stale = true;
+    }
+
+    void addInt(size_t slot, int64_t target) { ints.add(slot, &target); }
+    void addFloat(size_t slot, float target) { floats.add(slot, &target); }
+    void addDouble(size_t slot, double target) { doubles.add(slot, &target); }
+    void addColor(size_t slot, float r, float g, float b, float a) {
+        const float channels[4] = { r, g, b, a };
+        colors.add(slot, channels);
+        colorsChanged();
+    }
+
+    /// <summary>
+    /// Queue the numeric and color values of a decoded preset, bools are not interpolated
+    /// </summary>
+    void add(const ofxPresetsTargetSet& targets) {
+        ints.add(targets.ints);
+        floats.add(targets.floats);
+        doubles.add(targets.doubles);
+        colors.add(targets.colors);
+        vec2s.add(targets.vec2s);
+        vec3s.add(targets.vec3s);
+        vec4s.add(targets.vec4s);
+        floatColors.add(targets.floatColors);
+        rectangles.add(targets.rectangles);
+        quats.add(targets.quats);
+        colorsChanged();
+    }
+
+    /// <summary>
+    /// Start values of every lane from a set with the same slots as the targets, in the same order
+    /// </summary>
+    void setStart(const ofxPresetsTargetSet& values) {
+        ints.start = values.ints.values;
+        floats.start = values.floats.values;
+        doubles.start = values.doubles.values;
+        colors.start = values.colors.values;
+        vec2s.start = values.vec2s.values;
+        vec3s.start = values.vec3s.values;
+        vec4s.start = values.vec4s.values;
+        floatColors.start = values.floatColors.values;
+        rectangles.start = values.rectangles.values;
+        quats.start = values.quats.values;
+        colorsChanged();
+    }
+
+    /// <summary>
+    /// Copy the targets back into the set they were added from, i.e. once mutated
+    /// </summary>
+    void copyTargets(ofxPresetsTargetSet& targets) const {
+        targets.ints.values = ints.target;
+        targets.floats.values = floats.target;
+        targets.doubles.values = doubles.target;
+        targets.colors.values = colors.target;
+        targets.vec2s.values = vec2s.target;
+        targets.vec3s.values = vec3s.target;
+        targets.vec4s.values = vec4s.target;
+        targets.floatColors.values = floatColors.target;
+        targets.rectangles.values = rectangles.target;
+        targets.quats.values = quats.target;
+    }
+
+    /// <summary>
+    /// Compute the interpolated values of all lanes.
+    /// Numbers, vectors, rectangles and quaternions use the eased time, colors are blended linearly
+    /// </summary>
+    /// <param name="t">normalized time, between 0 and 1</param>
+    /// <param name="easedT">the easing function applied to t</param>
+    /// <param name="toBack">write to the back buffers instead of the values</param>
+    void evaluate(float t, float easedT, bool toBack = false) {
+        evaluated = evaluated || !toBack;
+        ints.evaluate(easedT, toBack);
+        floats.evaluate(easedT, toBack);
+        doubles.evaluate(easedT, toBack);
+        evaluateColors(colors, colorLab, 255.0f, t, toBack);
+        evaluateColors(floatColors, floatColorLab, 1.0f, t, toBack);
+        vec2s.evaluate(easedT, toBack);
+        vec3s.evaluate(easedT, toBack);
+        vec4s.evaluate(easedT, toBack);
+        rectangles.evaluate(easedT, toBack);
+        ofxSEeasing::slerp(quats.start.data(), quats.target.data(), easedT, quats.output(toBack), quats.size());
+    }
+
+    /// <summary>
+    /// Make the values computed into the back buffers the current ones
+    /// </summary>
+    void swapBuffers() {
+        evaluated = true;
+        ints.value.swap(ints.back);
+        floats.value.swap(floats.back);
+        doubles.value.swap(doubles.back);
+        colors.value.swap(colors.back);
+        vec2s.value.swap(vec2s.back);
+        vec3s.value.swap(vec3s.back);
+        vec4s.value.swap(vec4s.back);
+        floatColors.value.swap(floatColors.back);
+        rectangles.value.swap(rectangles.back);
+        quats.value.swap(quats.back);
+    }
+
+    /// <summary>
+    /// Bytes held by the lanes
+    /// </summary>
+    size_t memoryFootprint() const {
+        return ints.memoryFootprint() + floats.memoryFootprint() + doubles.memoryFootprint() + colors.memoryFootprint() +
+            vec2s.memoryFootprint() + vec3s.memoryFootprint() + vec4s.memoryFootprint() +
+            floatColors.memoryFootprint() + rectangles.memoryFootprint() + quats.memoryFootprint();
+    }
+
+private:
+    bool active = false;
+    bool evaluated = false; // the values hold an evaluation of this transition
+
+    // slot -> index in its lane of the interrupted transition, valid when stamped with the current generation
+    std::vector<uint32_t> inFlightIndex;
+    std::vector<uint32_t> inFlightGeneration;
+    uint32_t generation = 0;
+
+    template<typename Function>
+    void forEachLane(Function function) {
+        function(ints);
+        function(floats);
+        function(doubles);
+        function(colors);
+        function(vec2s);
+        function(vec3s);
+        function(vec4s);
+        function(floatColors);
+        function(rectangles);
+        function(quats);
+    }
+
+    // start, target and blended values of a color lane in OKLab
+    struct LabColors {
+        std::vector<float> start;
+        std::vector<float> target;
+        std::vector<float> value;
+        bool stale = true;
+    };
+    LabColors colorLab;
+    LabColors floatColorLab;
+
+    /// <summary>
+    /// Blend a color lane in the color space, the ends are copied as they are
+    /// </summary>
+    /// <param name="scale">channel range, 255 for ofColor and 1 for ofFloatColor</param>
+    void evaluateColors(Lane<float>& lane, LabColors& lab, float scale, float t, bool toBack) {
+        if (colorSpace == ofxPresetsColorSpace::RGB || t <= 0.0f || t >= 1.0f) {
+            lane.evaluate(t, toBack);
+            return;
+        }
+        if (lab.stale) {
+            lab.start.resize(lane.start.size());
+            lab.target.resize(lane.target.size());
+            lab.value.resize(lane.target.size());
+            ofxPresetsColor::toOKLab(lane.start.data(), lab.start.data(), lane.size(), scale);
+            ofxPresetsColor::toOKLab(lane.target.data(), lab.target.data(), lane.size(), scale);
+            lab.stale = false;
+        }
+        ofxSEeasing::lerp(lab.start.data(), lab.target.data(), t, lab.value.data(), lab.value.size());
+        ofxPresetsColor::fromOKLab(lab.value.data(), lane.output(toBack), lane.size(), scale);
+    }
+};
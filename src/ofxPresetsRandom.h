@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+/// <summary>
+/// Seedable random generator, one per manager: xoshiro256** for the bits, Ziggurat (Marsaglia and Tsang, 128 layers)
+/// for normally distributed values. Nothing is shared between instances, and the same seed gives the same values
+/// in the same order, so random steps and mutations can be replayed
+/// </summary>
+class ofxPresetsRandom {
+public:
+
+    /// <summary>
+    /// Seeded from std::random_device, call seed() to replay
+    /// </summary>
+    ofxPresetsRandom() {
+        std::random_device device;
+        seed((static_cast<uint64_t>(device()) << 32) ^ device());
+    }
+
+    explicit ofxPresetsRandom(uint64_t value) {
+        seed(value);
+    }
+
+    /// <summary>
+    /// One of the independent streams of a seed, i.e. one per sequence step, so a step gets the same values however it is reached
+    /// </summary>
+    ofxPresetsRandom(uint64_t value, uint64_t stream) {
+        seed(value ^ mix(stream + 0x9e3779b97f4a7c15ull));
+    }
+
+    /// <summary>
+    /// Restart the generator, the state is expanded from the seed with splitmix64
+    /// </summary>
+    void seed(uint64_t value) {
+        seedValue = value;
+        for (auto& word : state) {
+            value += 0x9e3779b97f4a7c15ull;
+            word = mix(value);
+        }
+    }
+
+    uint64_t getSeed() const { return seedValue; }
+
+    uint64_t next() {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    /// <summary>
+    /// Uniform in [0, 1), 53 bits
+    /// </summary>
+    double uniform() {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+    /// <summary>
+    /// Uniform in [min, max)
+    /// </summary>
+    float uniform(float min, float max) {
+        return min + static_cast<float>(uniform() * (static_cast<double>(max) - min));
+    }
+
+    /// <summary>
+    /// Uniform integer in [0, n)
+    /// </summary>
+    size_t below(size_t n) {
+        return n == 0 ? 0 : std::min(static_cast<size_t>(uniform() * n), n - 1);
+    }
+
+    /// <summary>
+    /// Standard normal value
+    /// </summary>
+    float normal() {
+        const Tables& t = tables();
+        const uint64_t bits = next();
+        const size_t layer = bits & 127;
+        const int32_t x = static_cast<int32_t>(bits >> 32); // sign and position from other bits than the layer
+        if (magnitude(x) < t.k[layer]) {
+            return static_cast<float>(x * t.w[layer]); // inside the layer, 98.8% of the values
+        }
+        return tail(x, layer);
+    }
+
+    /// <summary>
+    /// Fill an array with normal values of a deviation, i.e. all the noise of a mutation at once
+    /// </summary>
+    void normals(float* out, size_t n, float deviation) {
+        const Tables& t = tables();
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t bits = next();
+            const size_t layer = bits & 127;
+            const int32_t x = static_cast<int32_t>(bits >> 32);
+            const float value = magnitude(x) < t.k[layer] ? static_cast<float>(x * t.w[layer]) : tail(x, layer);
+            out[i] = value * deviation;
+        }
+    }
+
+private:
+    uint64_t state[4];
+    uint64_t seedValue = 0;
+
+    struct Tables {
+        uint32_t k[128]; // bounds of the layers, in the scale of the 32 bit values
+        double w[128];   // 32 bit value to x
+        double f[128];   // density at the edge of each layer
+    };
+
+    static constexpr double r = 3.442619855899;       // start of the tail
+    static constexpr double area = 9.91256303526217e-3; // of each layer
+
+    // splitmix64 output function
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint32_t magnitude(int32_t x) {
+        return static_cast<uint32_t>(x < 0 ? -static_cast<int64_t>(x) : x);
+    }
+
+    static const Tables& tables() {
+        static const Tables t = [] {
+            Tables t;
+            const double m = 2147483648.0;
+            double d = r;
+            double previous = r;
+            const double q = area / std::exp(-0.5 * d * d);
+            t.k[0] = static_cast<uint32_t>((d / q) * m);
+            t.k[1] = 0;
+            t.w[0] = q / m;
+            t.w[127] = d / m;
+            t.f[0] = 1.0;
+            t.f[127] = std::exp(-0.5 * d * d);
+            for (int i = 126; i >= 1; --i) {
+                d = std::sqrt(-2.0 * std::log(area / d + std::exp(-0.5 * d * d)));
+                t.k[i + 1] = static_cast<uint32_t>((d / previous) * m);
+                previous = d;
+                t.f[i] = std::exp(-0.5 * d * d);
+                t.w[i] = d / m;
+            }
+            return t;
+        }();
+        return t;
+    }
+
+    // outside the rectangle of the layer: the wedge, or the tail past r for the base layer
+    float tail(int32_t x, size_t layer) {
+        const Tables& t = tables();
+        for (;;) {
+            const double value = x * t.w[layer];
+            if (layer == 0) {
+                double a, b;
+                do {
+                    a = -std::log(1.0 - uniform()) / r;
+                    b = -std::log(1.0 - uniform());
+                } while (b + b < a * a);
+                return static_cast<float>(x > 0 ? r + a : -r - a);
+            }
+            if (t.f[layer] + uniform() * (t.f[layer - 1] - t.f[layer]) < std::exp(-0.5 * value * value)) {
+                return static_cast<float>(value);
+            }
+
+            const uint64_t bits = next();
+            layer = bits & 127;
+            x = static_cast<int32_t>(bits >> 32);
+            if (magnitude(x) < t.k[layer]) {
+                return static_cast<float>(x * t.w[layer]);
+            }
+        }
+    }
+};
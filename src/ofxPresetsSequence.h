@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One step of a sequence
+struct ofxPresetsSequenceStep {
+    int presetId = 0;          // 0 for a random preset, negative for a mutation of the preset
+    float hold = -1.0f;        // seconds, negative for sequencePresetDuration
+    float transition = -1.0f;  // seconds, negative for interpolationDuration
+    uint32_t firstChoice = 0;  // random steps: the presets to pick from, in the choices of the sequence. None for any preset
+    uint32_t choiceCount = 0;
+};
+
+
+// A preset a random step can pick, with its odds relative to the others of the step
+struct ofxPresetsSequenceChoice {
+    int presetId = 0;
+    float weight = 1.0f;
+};
+
+
+// A run of steps, or a repeated group of segments. The segments of a sequence are stored depth first, each group before its content
+struct ofxPresetsSequenceSegment {
+    // runs
+    int from = 0;              // preset of the first step
+    int direction = 0;         // added to the preset from one step to the next: 1 or -1 for ranges, 0 repeats it
+    float hold = -1.0f;        // of every step of the run
+    float transition = -1.0f;
+    uint32_t firstChoice = 0;  // random steps
+    uint32_t choiceCount = 0;
+
+    // groups
+    uint32_t firstChild = 0;   // in the children of the sequence
+    uint32_t childCount = 0;   // 0 for a run
+    uint32_t repeat = 1;       // passes
+    uint32_t end = 0;          // index after the last segment of the group, or of the run itself
+
+    uint64_t steps = 0;        // one pass
+    uint64_t offset = 0;       // first step, from the start of a pass of the parent group
+
+    bool isGroup() const { return childCount > 0; }
+};
+
+
+/// <summary>
+/// A sequence stored as its segments, as it was written: "1-1000000" is one run and "(1, 2)x1000" a group of two runs,
+/// memory grows with the length of the string and not with the steps it plays.
+/// Steps are read with a Cursor, one after the other, or by index with a search down the groups
+/// </summary>
+class ofxPresetsSequence {
+public:
+    static constexpr size_t maxDepth = 16;            // nested groups
+    static constexpr uint64_t maxSteps = 0x7fffffff;  // of one loop, indexed as int
+
+    std::vector<ofxPresetsSequenceSegment> segments;  // the first one is a group of the whole sequence, played once
+    std::vector<uint32_t> children;                   // segments in each group, in order
+    std::vector<ofxPresetsSequenceChoice> choices;
+
+    void clear() {
+        segments.clear();
+        children.clear();
+        choices.clear();
+    }
+
+    void swap(ofxPresetsSequence& other) {
+        segments.swap(other.segments);
+        children.swap(other.children);
+        choices.swap(other.choices);
+    }
+
+    /// <summary>
+    /// Steps of one loop
+    /// </summary>
+    uint64_t size() const { return segments.empty() ? 0 : segments[0].steps; }
+    bool empty() const { return size() == 0; }
+
+    /// <summary>
+    /// Step at an index, looping. Searches down the groups, use a Cursor to go through the steps
+    /// </summary>
+    ofxPresetsSequenceStep operator[](uint64_t index) const {
+        uint32_t segment = 0;
+        index %= size();
+        while (segments[segment].isGroup()) {
+            index %= segments[segment].steps; // the pass
+            segment = children[segments[segment].firstChild + childAt(segment, index)];
+            index -= segments[segment].offset;
+        }
+        return runStep(segment, index);
+    }
+
+    /// <summary>
+    /// Child of a group with a step of a pass of it
+    /// </summary>
+    /// <returns>position in the children of the group</returns>
+    uint32_t childAt(uint32_t group, uint64_t step) const {
+        auto first = children.begin() + segments[group].firstChild;
+        auto last = first + segments[group].childCount;
+        auto child = std::upper_bound(first, last, step,
+            [this](uint64_t s, uint32_t c) { return s < segments[c].offset; });
+        return static_cast<uint32_t>(child - first) - 1;
+    }
+
+    ofxPresetsSequenceStep runStep(uint32_t run, uint64_t step) const {
+        const auto& segment = segments[run];
+        ofxPresetsSequenceStep result;
+        result.presetId = segment.from + segment.direction * static_cast<int>(step);
+        result.hold = segment.hold;
+        result.transition = segment.transition;
+        result.firstChoice = segment.firstChoice;
+        result.choiceCount = segment.choiceCount;
+        return result;
+    }
+
+    /// <summary>
+    /// A sequence of single steps, one run each
+    /// </summary>
+    /// <param name="ids">presets, 0 for random and negative for mutations</param>
+    void assign(const std::vector<int>& ids) {
+        clear();
+        if (ids.empty()) {
+            return;
+        }
+        segments.resize(ids.size() + 1);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto& run = segments[i + 1];
+            run.from = ids[i];
+            run.steps = 1;
+            run.offset = i;
+            run.end = static_cast<uint32_t>(i + 2);
+            children.push_back(static_cast<uint32_t>(i + 1));
+        }
+        auto& root = segments[0];
+        root.childCount = static_cast<uint32_t>(ids.size());
+        root.steps = std::min<uint64_t>(ids.size(), maxSteps);
+        root.end = static_cast<uint32_t>(segments.size());
+    }
+
+    /// <summary>
+    /// The sequence written back as a sequence string, i.e. for display
+    /// </summary>
+    std::string toString() const {
+        std::string out;
+        if (!empty()) {
+            write(out, 0);
+        }
+        return out;
+    }
+
+    /// <summary>
+    /// Goes through the steps of a sequence, looping. advance() moves to the next step in constant time
+    /// (amortized, a group is entered and left once per pass), seek() to any step searching down the groups.
+    /// It does not allocate and can be copied to look ahead. A new content of the sequence needs a seek(0)
+    /// </summary>
+    class Cursor {
+    public:
+        Cursor() = default;
+        explicit Cursor(const ofxPresetsSequence& s) : sequence(&s) { seek(0); }
+
+        uint64_t index() const { return position; }
+
+        ofxPresetsSequenceStep step() const {
+            return sequence->runStep(run, offset);
+        }
+
+        void seek(uint64_t index) {
+            depth = 0;
+            run = 0;
+            offset = 0;
+            position = 0;
+            if (sequence == nullptr || sequence->empty()) {
+                return;
+            }
+            position = index % sequence->size();
+
+            const auto& segments = sequence->segments;
+            uint32_t segment = 0;
+            uint64_t step = position;
+            while (segments[segment].isGroup()) {
+                const auto& group = segments[segment];
+                Level& level = levels[depth++];
+                level.group = segment;
+                level.pass = static_cast<uint32_t>(step / group.steps);
+                step %= group.steps;
+                level.child = sequence->childAt(segment, step);
+                segment = sequence->children[group.firstChild + level.child];
+                step -= segments[segment].offset;
+            }
+            run = segment;
+            offset = step;
+        }
+
+        void advance() {
+            if (sequence == nullptr || sequence->empty()) {
+                return;
+            }
+            const auto& segments = sequence->segments;
+            ++position;
+            if (++offset < segments[run].steps) {
+                return;
+            }
+
+            // out of the groups that are done, the whole sequence loops
+            for (;;) {
+                Level& level = levels[depth - 1];
+                const auto& group = segments[level.group];
+                if (++level.child < group.childCount) {
+                    break;
+                }
+                level.child = 0;
+                if (++level.pass < group.repeat) {
+                    break;
+                }
+                level.pass = 0;
+                if (depth == 1) {
+                    position = 0;
+                    break;
+                }
+                --depth;
+            }
+
+            // into the first run of the next segment
+            const Level& level = levels[depth - 1];
+            uint32_t segment = sequence->children[segments[level.group].firstChild + level.child];
+            while (segments[segment].isGroup()) {
+                levels[depth++] = Level{ segment, 0, 0 };
+                segment = sequence->children[segments[segment].firstChild];
+            }
+            run = segment;
+            offset = 0;
+        }
+
+    private:
+        struct Level {
+            uint32_t group;
+            uint32_t child; // in the children of the group
+            uint32_t pass;
+        };
+
+        const ofxPresetsSequence* sequence = nullptr;
+        Level levels[maxDepth + 1] = {};
+        size_t depth = 0;
+        uint32_t run = 0;
+        uint64_t offset = 0;   // in the run
+        uint64_t position = 0; // in the sequence
+    };
+
+private:
+    void write(std::string& out, uint32_t index) const {
+        const auto& segment = segments[index];
+        if (segment.isGroup()) {
+            const bool root = index == 0;
+            if (!root) {
+                out += '(';
+            }
+            for (uint32_t c = 0; c < segment.childCount; ++c) {
+                if (c) {
+                    out += ", ";
+                }
+                write(out, children[segment.firstChild + c]);
+            }
+            if (!root) {
+                out += ')';
+                if (segment.repeat > 1) {
+                    out += 'x' + std::to_string(segment.repeat);
+                }
+            }
+            return;
+        }
+
+        const int last = segment.from + segment.direction * static_cast<int>(segment.steps - 1);
+        if (segment.choiceCount > 0) {
+            out += "?{";
+            for (uint32_t c = 0; c < segment.choiceCount; ++c) {
+                const auto& choice = choices[segment.firstChoice + c];
+                out += (c ? ", " : "") + std::to_string(choice.presetId);
+                if (choice.weight != 1.0f) {
+                    out += ':' + number(choice.weight);
+                }
+            }
+            out += '}';
+        }
+        else if (segment.direction != 0) { // before random steps, a range can start at 0
+            out += std::to_string(segment.from) + '-' + std::to_string(last);
+        }
+        else if (segment.from == 0) {
+            out += segment.steps > 1 ? "?-" + std::to_string(segment.steps) : "?";
+        }
+        else if (segment.from < 0) {
+            out += std::to_string(-segment.from) + '*';
+        }
+        else {
+            out += std::to_string(segment.from);
+        }
+
+        if (segment.hold >= 0.0f || segment.transition >= 0.0f) {
+            out += '@';
+            if (segment.hold >= 0.0f) {
+                out += number(segment.hold);
+            }
+            if (segment.transition >= 0.0f) {
+                out += '/' + number(segment.transition);
+            }
+        }
+    }
+
+    static std::string number(float value) {
+        std::string text = std::to_string(value);
+        text.erase(text.find_last_not_of('0') + 1);
+        if (text.back() == '.') {
+            text.pop_back();
+        }
+        return text;
+    }
+};
@@ -0,0 +1,375 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "ofxPresetsSequence.h"
+
+// Where and why a sequence string could not be parsed
+struct ofxPresetsSequenceError {
+    size_t position = 0;      // character of the string
+    const char* message = "";
+};
+
+
+/// <summary>
+/// Single pass parser of sequence strings. It does not allocate: the segments are appended to the vectors of the sequence,
+/// which keep their capacity from one call to the next, and errors point into static messages.
+/// Ranges and groups are not expanded, see ofxPresetsSequence
+///
+///   1, 2, 3          steps
+///   1 - 5, 5 - 1     ranges, in both directions
+///   ?                a random preset
+///   ? - 3, 3 - ?     3 random presets
+///   ?{1, 4, 7:2}     a random preset among 1, 4 and 7, 7 twice as likely (weights are relative, 1 by default)
+///   5*, *5           preset 5, mutated
+///   (1, 2, 5)x4      a group repeated 4 times, groups can be nested
+///   3@2.0/0.5        hold preset 3 for 2 s after a transition of 0.5 s, `3@2` sets only the hold and `3@/0.5` only the transition.
+///                    After a range or a group, the timing applies to all of its steps that do not have one
+///
+/// Spaces are ignored, anything else is an error
+/// </summary>
+class ofxPresetsSequenceParser {
+public:
+    static constexpr int maxNumber = 1000000000;
+
+    /// <summary>
+    /// Parse a sequence string, replacing the content of sequence
+    /// </summary>
+    /// <returns>false on a syntax error, sequence is then left in an unspecified state</returns>
+    static bool parse(std::string_view input, ofxPresetsSequence& sequence, ofxPresetsSequenceError& error) {
+        sequence.clear();
+        Parser parser{ input, 0, sequence.segments, sequence.children, sequence.choices, error };
+
+        parser.openGroup(); // the whole sequence
+        parser.skipSpaces();
+        if (!parser.atEnd() && !parser.list(0)) {
+            return false;
+        }
+        if (!parser.atEnd()) {
+            return parser.fail(parser.peek() == ')' ? "unbalanced )" : "expected , between steps");
+        }
+        return parser.closeGroup(0, 1);
+    }
+
+    /// <summary>
+    /// Characters of the syntax, spaces aside
+    /// </summary>
+    static bool isSyntaxCharacter(char c) {
+        return (c >= '0' && c <= '9') || std::string_view(",-?*{}:()xX@/.").find(c) != std::string_view::npos;
+    }
+
+private:
+    struct Parser {
+        std::string_view text;
+        size_t i;
+        std::vector<ofxPresetsSequenceSegment>& segments;
+        std::vector<uint32_t>& children;
+        std::vector<ofxPresetsSequenceChoice>& choices;
+        ofxPresetsSequenceError& error;
+
+        bool atEnd() const { return i >= text.size(); }
+        char peek() const { return atEnd() ? '\0' : text[i]; }
+        static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+        void skipSpaces() {
+            while (!atEnd() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' || text[i] == '\r')) {
+                ++i;
+            }
+        }
+
+        bool fail(const char* message) {
+            return failAt(i, message);
+        }
+
+        bool failAt(size_t position, const char* message) {
+            error.position = position;
+            error.message = message;
+            return false;
+        }
+
+        // comma separated items, up to the end or a )
+        bool list(size_t depth) {
+            for (;;) {
+                skipSpaces();
+                if (!item(depth)) {
+                    return false;
+                }
+                skipSpaces();
+                if (peek() != ',') {
+                    return true;
+                }
+                ++i;
+            }
+        }
+
+        // a step or a group, with its timing
+        bool item(size_t depth) {
+            const size_t first = segments.size();
+            if (peek() == '(') {
+                if (depth + 1 >= ofxPresetsSequence::maxDepth) {
+                    return fail("groups nested too deep");
+                }
+                ++i;
+                skipSpaces();
+                if (peek() == ')') {
+                    return fail("empty group");
+                }
+                const uint32_t group = openGroup();
+                if (!list(depth + 1)) {
+                    return false;
+                }
+                if (peek() != ')') {
+                    return fail("expected ) to close the group");
+                }
+                ++i;
+                skipSpaces();
+                int count = 1;
+                if (peek() == 'x' || peek() == 'X') {
+                    ++i;
+                    skipSpaces();
+                    const size_t countStart = i;
+                    if (!number(count)) {
+                        return false;
+                    }
+                    if (count < 1) {
+                        return failAt(countStart, "a group repeats at least once");
+                    }
+                }
+                if (!closeGroup(group, static_cast<uint32_t>(count))) {
+                    return false;
+                }
+            }
+            else if (!step()) {
+                return false;
+            }
+
+            skipSpaces();
+            return peek() == '@' ? timing(first) : true;
+        }
+
+        bool step() {
+            const char c = peek();
+            if (c == '?') {
+                ++i;
+                skipSpaces();
+                if (peek() == '{') {
+                    return choiceStep();
+                }
+                if (peek() != '-') {
+                    return addRun(0, 0, 1);
+                }
+                ++i;
+                skipSpaces();
+                if (peek() == '?') { // ?-? is a single random step
+                    ++i;
+                    return addRun(0, 0, 1);
+                }
+                int count = 0;
+                return number(count) && addRun(0, 0, static_cast<uint64_t>(count));
+            }
+
+            if (c == '*') {
+                ++i;
+                skipSpaces();
+                int id = 0;
+                return number(id) && addRun(-id, 0, 1);
+            }
+
+            if (!isDigit(c)) {
+                return fail(atEnd() || c == ',' || c == ')' ? "expected a step" : "unexpected character");
+            }
+
+            int from = 0;
+            if (!number(from)) {
+                return false;
+            }
+            skipSpaces();
+            if (peek() == '*') {
+                ++i;
+                return addRun(-from, 0, 1);
+            }
+            if (peek() != '-') {
+                return addRun(from, 0, 1);
+            }
+            ++i;
+            skipSpaces();
+            if (peek() == '?') { // 3-? is 3 random steps
+                ++i;
+                return addRun(0, 0, static_cast<uint64_t>(from));
+            }
+            int to = 0;
+            if (!number(to)) {
+                return false;
+            }
+            return addRun(from, from > to ? -1 : 1, static_cast<uint64_t>(from > to ? from - to : to - from) + 1);
+        }
+
+        // ?{1, 4:2, 7}
+        bool choiceStep() {
+            ++i;
+            const uint32_t firstChoice = static_cast<uint32_t>(choices.size());
+            for (;;) {
+                skipSpaces();
+                const size_t choiceStart = i;
+                ofxPresetsSequenceChoice choice;
+                if (!number(choice.presetId)) {
+                    return false;
+                }
+                if (choice.presetId < 1) {
+                    return failAt(choiceStart, "random choices are presets from 1");
+                }
+                skipSpaces();
+                if (peek() == ':') {
+                    ++i;
+                    skipSpaces();
+                    if (!decimal(choice.weight)) {
+                        return false;
+                    }
+                }
+                choices.push_back(choice);
+
+                skipSpaces();
+                if (peek() == '}') {
+                    ++i;
+                    break;
+                }
+                if (peek() != ',') {
+                    return fail("expected , or } in the random choices");
+                }
+                ++i;
+            }
+            if (!addRun(0, 0, 1)) {
+                return false;
+            }
+            segments.back().firstChoice = firstChoice;
+            segments.back().choiceCount = static_cast<uint32_t>(choices.size()) - firstChoice;
+            return true;
+        }
+
+        // @hold, @hold/transition or @/transition, for the runs from first that have none
+        bool timing(size_t first) {
+            ++i;
+            skipSpaces();
+            float hold = -1.0f;
+            float transition = -1.0f;
+            if (peek() != '/' && !decimal(hold)) {
+                return false;
+            }
+            skipSpaces();
+            if (peek() == '/') {
+                ++i;
+                skipSpaces();
+                if (!decimal(transition)) {
+                    return false;
+                }
+            }
+            for (size_t s = first; s < segments.size(); ++s) {
+                if (segments[s].hold < 0.0f && hold >= 0.0f) {
+                    segments[s].hold = hold;
+                }
+                if (segments[s].transition < 0.0f && transition >= 0.0f) {
+                    segments[s].transition = transition;
+                }
+            }
+            return true;
+        }
+
+        // runs of no steps (?-0) are left out
+        bool addRun(int from, int direction, uint64_t steps) {
+            if (steps == 0) {
+                return true;
+            }
+            if (steps > ofxPresetsSequence::maxSteps) {
+                return fail("sequence too long");
+            }
+            ofxPresetsSequenceSegment run;
+            run.from = from;
+            run.direction = direction;
+            run.steps = steps;
+            run.end = static_cast<uint32_t>(segments.size() + 1);
+            segments.push_back(run);
+            return true;
+        }
+
+        uint32_t openGroup() {
+            segments.emplace_back();
+            return static_cast<uint32_t>(segments.size() - 1);
+        }
+
+        // the segments after the group are its content, a group of no steps is left out
+        bool closeGroup(uint32_t group, uint32_t repeat) {
+            const uint32_t firstChild = static_cast<uint32_t>(children.size());
+            uint64_t steps = 0;
+            for (uint32_t child = group + 1; child < segments.size(); child = segments[child].end) {
+                segments[child].offset = steps;
+                steps += segments[child].steps * segments[child].repeat;
+                if (steps > ofxPresetsSequence::maxSteps) {
+                    return fail("sequence too long");
+                }
+                children.push_back(child);
+            }
+            if (steps * repeat > ofxPresetsSequence::maxSteps) {
+                return fail("sequence too long");
+            }
+            if (steps == 0) {
+                segments.resize(group);
+                children.resize(firstChild);
+                return true;
+            }
+
+            auto& segment = segments[group];
+            segment.firstChild = firstChild;
+            segment.childCount = static_cast<uint32_t>(children.size()) - firstChild;
+            segment.repeat = repeat;
+            segment.steps = steps;
+            segment.end = static_cast<uint32_t>(segments.size());
+            return true;
+        }
+
+        bool number(int& value) {
+            if (!isDigit(peek())) {
+                return fail("expected a number");
+            }
+            const size_t start = i;
+            int64_t v = 0;
+            while (isDigit(peek())) {
+                v = v * 10 + (text[i] - '0');
+                if (v > maxNumber) {
+                    return failAt(start, "number too large");
+                }
+                ++i;
+            }
+            value = static_cast<int>(v);
+            return true;
+        }
+
+        // seconds or weights: digits with an optional fraction, i.e. 2, 0.5 or .5
+        bool decimal(float& value) {
+            if (!isDigit(peek()) && !(peek() == '.' && i + 1 < text.size() && isDigit(text[i + 1]))) {
+                return fail("expected a number");
+            }
+            const size_t start = i;
+            double v = 0.0;
+            while (isDigit(peek())) {
+                v = v * 10.0 + (text[i] - '0');
+                if (v > maxNumber) {
+                    return failAt(start, "number too large");
+                }
+                ++i;
+            }
+            if (peek() == '.') {
+                ++i;
+                double scale = 0.1;
+                while (isDigit(peek())) {
+                    v += (text[i] - '0') * scale;
+                    scale *= 0.1;
+                    ++i;
+                }
+            }
+            value = static_cast<float>(v);
+            return true;
+        }
+    };
+};
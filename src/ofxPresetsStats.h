@@ -0,0 +1,177 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <ofParameter.h>
+
+// Hot path instrumentation, off by default.
+// Define OFX_PRESETS_STATS in the project to enable it, otherwise the OFX_PRESETS_STATS_* macros compile to nothing
+// and getStats() is an empty group
+
+#ifdef OFX_PRESETS_STATS
+#define OFX_PRESETS_STATS_CONCAT_(a, b) a##b
+#define OFX_PRESETS_STATS_CONCAT(a, b) OFX_PRESETS_STATS_CONCAT_(a, b)
+// time the rest of the scope into a stage
+#define OFX_PRESETS_STATS_TIME(stats, stage) ofxPresetsStats::Timer OFX_PRESETS_STATS_CONCAT(ofxPresetsStatsTimer, __LINE__)(stats, ofxPresetsStats::stage)
+// run a statement only when instrumenting
+#define OFX_PRESETS_STATS_DO(statement) statement
+#else
+#define OFX_PRESETS_STATS_TIME(stats, stage)
+#define OFX_PRESETS_STATS_DO(statement)
+#endif
+
+
+#ifdef OFX_PRESETS_STATS
+
+/// <summary>
+/// Timers and counters of the preset manager, published once per frame as read-only parameters.
+/// Times are in microseconds, "last" is the cost in the last frame (from one update() to the next,
+/// including presets applied in between) and "max" the worst frame since the last reset().
+/// Work done on a worker thread (sequence prefetch, threaded interpolation) goes to the background stage, not to the frame.
+/// The interpolation latency is how late the applied values are with threaded interpolation, see ofxPresets::setThreadedInterpolation()
+/// </summary>
+class ofxPresetsStats {
+public:
+    enum Stage {
+        FileIO,       // opening, reading or mapping preset files
+        Parse,        // parsing json and decoding values
+        StoreValues,  // reading the start values of a transition
+        Interpolate,  // interpolation and easing sweep, or the wait for the worker when threaded
+        Notify,       // setting the changed parameters, with their listeners
+        Background,   // work on worker threads: prefetch, threaded interpolation
+        StageCount
+    };
+
+    ofxPresetsStats() {
+        static const char* names[StageCount] = { "file io", "parse", "store values", "interpolate", "set and notify", "background" };
+
+        group.setName("ofxPresets stats");
+        for (size_t i = 0; i < StageCount; ++i) {
+            group.add(lastTimes[i].set(std::string(names[i]) + " us", 0.0f, 0.0f, frameMicros));
+            group.add(maxTimes[i].set(std::string(names[i]) + " max us", 0.0f, 0.0f, frameMicros));
+        }
+        group.add(presetsApplied.set("presets applied", 0, 0, std::numeric_limits<int>::max()));
+        group.add(parametersTouched.set("parameters touched", 0, 0, std::numeric_limits<int>::max()));
+        group.add(parametersTouchedMax.set("parameters touched max", 0, 0, std::numeric_limits<int>::max()));
+        group.add(bytesRead.set("bytes read", 0, 0, std::numeric_limits<uint64_t>::max()));
+        group.add(interpolationLatency.set("interpolation latency us", 0.0f, -frameMicros, frameMicros));
+
+        frameThread = std::this_thread::get_id();
+    }
+
+    /// <summary>
+    /// Times a scope
+    /// </summary>
+    class Timer {
+    public:
+        Timer(ofxPresetsStats& stats, Stage stage) : stats(stats), stage(stage), start(std::chrono::steady_clock::now()) {}
+        ~Timer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            stats.addTime(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        ofxPresetsStats& stats;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void addTime(Stage stage, int64_t nanoseconds) {
+        if (stage == Background || std::this_thread::get_id() != frameThread.load(std::memory_order_relaxed)) {
+            backgroundNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+            return;
+        }
+        frameNanoseconds[stage] += nanoseconds;
+    }
+
+    void addPresetApplied() { ++presetsAppliedCount; }
+    void addParametersTouched(size_t count) { parametersTouchedCount += static_cast<int>(count); }
+    void addBytesRead(size_t count) { bytesReadCount.fetch_add(count, std::memory_order_relaxed); }
+    void setInterpolationLatency(double seconds) { latencySeconds = seconds; }
+
+    /// <summary>
+    /// Publish the frame values to the parameters, called at the end of each update() on the frame thread
+    /// </summary>
+    void endFrame() {
+        frameThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        frameNanoseconds[Background] = backgroundNanoseconds.exchange(0, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < StageCount; ++i) {
+            float micros = frameNanoseconds[i] / 1000.0f;
+            lastTimes[i].set(micros);
+            if (micros > maxTimes[i].get()) {
+                maxTimes[i].set(micros);
+            }
+            frameNanoseconds[i] = 0;
+        }
+
+        presetsApplied.set(presetsAppliedCount);
+        parametersTouched.set(parametersTouchedCount);
+        if (parametersTouchedCount > parametersTouchedMax.get()) {
+            parametersTouchedMax.set(parametersTouchedCount);
+        }
+        parametersTouchedCount = 0;
+        bytesRead.set(bytesReadCount.load(std::memory_order_relaxed));
+        interpolationLatency.set(static_cast<float>(latencySeconds * 1000000.0));
+    }
+
+    /// <summary>
+    /// Clear the max values and the totals
+    /// </summary>
+    void reset() {
+        for (size_t i = 0; i < StageCount; ++i) {
+            maxTimes[i].set(0.0f);
+        }
+        parametersTouchedMax.set(0);
+        presetsAppliedCount = 0;
+        presetsApplied.set(0);
+        bytesReadCount.store(0, std::memory_order_relaxed);
+        bytesRead.set(0);
+    }
+
+    const ofParameterGroup& getGroup() const { return group; }
+
+private:
+    static constexpr float frameMicros = 1000000.0f / 60.0f; // slider range of the times, one frame at 60 fps
+
+    ofParameterGroup group;
+    ofParameter<float> lastTimes[StageCount];
+    ofParameter<float> maxTimes[StageCount];
+    ofParameter<int> presetsApplied;
+    ofParameter<int> parametersTouched;
+    ofParameter<int> parametersTouchedMax;
+    ofParameter<uint64_t> bytesRead;
+    ofParameter<float> interpolationLatency;
+
+    std::atomic<std::thread::id> frameThread;
+    int64_t frameNanoseconds[StageCount] = {};
+    std::atomic<int64_t> backgroundNanoseconds{ 0 };
+    int presetsAppliedCount = 0;
+    int parametersTouchedCount = 0;
+    std::atomic<uint64_t> bytesReadCount{ 0 };
+    double latencySeconds = 0.0;
+};
+
+#else
+
+/// <summary>
+/// Instrumentation disabled, see OFX_PRESETS_STATS
+/// </summary>
+class ofxPresetsStats {
+public:
+    ofxPresetsStats() {
+        group.setName("ofxPresets stats");
+    }
+
+    void reset() {}
+
+    const ofParameterGroup& getGroup() const { return group; }
+
+private:
+    ofParameterGroup group;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "ofxPresetsSequence.h"
+
+// One step of a compiled sequence: its transition starts at `start`, then the preset holds
+struct ofxPresetsTimelineEvent {
+    double start = 0.0;      // seconds from the start of the sequence
+    float transition = 0.0f; // seconds
+    float hold = 0.0f;       // seconds, after the transition
+};
+
+
+/// <summary>
+/// The steps of a sequence laid out in time, one loop of the sequence.
+/// The durations are kept per segment of the sequence, not per step, and steps are found by their position in time
+/// with a binary search down the groups, so the sequencer schedules every step from the start of the sequence
+/// (no drift from frame to frame) and can seek anywhere in it
+/// </summary>
+class ofxPresetsTimeline {
+public:
+
+    /// <summary>
+    /// Lay out a sequence, the steps without their own times take hold and transition.
+    /// The sequence is read until the next compile, it must outlive the timeline
+    /// </summary>
+    void compile(const ofxPresetsSequence& steps, float hold, float transition) {
+        sequence = &steps;
+        defaultHold = std::max(hold, 0.0f);
+        defaultTransition = std::max(transition, 0.0f);
+
+        // children come after their group, so the durations are summed up from the end
+        const auto& segments = steps.segments;
+        durations.assign(segments.size(), 0.0);
+        starts.assign(segments.size(), 0.0);
+        for (size_t i = segments.size(); i-- > 0;) {
+            const auto& segment = segments[i];
+            if (!segment.isGroup()) {
+                durations[i] = segment.steps * stepDuration(segment);
+                continue;
+            }
+            double pass = 0.0;
+            for (uint32_t c = 0; c < segment.childCount; ++c) {
+                uint32_t child = steps.children[segment.firstChild + c];
+                starts[child] = pass;
+                pass += durations[child] * segments[child].repeat;
+            }
+            durations[i] = pass;
+        }
+        loopDuration = segments.empty() ? 0.0 : durations[0];
+    }
+
+    uint64_t size() const { return sequence ? sequence->size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    /// <summary>
+    /// Timing of a step, searching down the groups
+    /// </summary>
+    ofxPresetsTimelineEvent operator[](uint64_t index) const {
+        const auto& segments = sequence->segments;
+        double start = 0.0;
+        uint32_t segment = 0;
+        while (segments[segment].isGroup()) {
+            const auto& group = segments[segment];
+            start += (index / group.steps) * durations[segment];
+            index %= group.steps;
+            segment = sequence->children[group.firstChild + sequence->childAt(segment, index)];
+            start += starts[segment];
+            index -= segments[segment].offset;
+        }
+
+        ofxPresetsTimelineEvent event;
+        event.transition = transitionOf(segments[segment]);
+        event.hold = holdOf(segments[segment]);
+        event.start = start + index * stepDuration(segments[segment]);
+        return event;
+    }
+
+    /// <summary>
+    /// Length of one loop of the sequence, in seconds
+    /// </summary>
+    double duration() const { return loopDuration; }
+
+    /// <summary>
+    /// Step playing at a time of the sequence, looping. Steps of zero duration are skipped
+    /// </summary>
+    /// <param name="time">seconds from the start of the sequence</param>
+    /// <param name="stepStart">start of that step, in seconds from the start of the sequence</param>
+    /// <returns>index of the step</returns>
+    uint64_t find(double time, double& stepStart) const {
+        if (loopDuration <= 0.0) {
+            stepStart = 0.0;
+            return 0;
+        }
+        const auto& segments = sequence->segments;
+        double loop = std::floor(std::max(time, 0.0) / loopDuration);
+        double position = std::max(time, 0.0) - loop * loopDuration;
+        double start = loop * loopDuration;
+        uint64_t index = 0;
+
+        uint32_t segment = 0;
+        while (segments[segment].isGroup()) {
+            const auto& group = segments[segment];
+            const double pass = passAt(position, durations[segment], group.repeat);
+            position -= pass * durations[segment];
+            start += pass * durations[segment];
+            index += static_cast<uint64_t>(pass) * group.steps;
+
+            // the last child started by then
+            auto first = sequence->children.begin() + group.firstChild;
+            auto child = std::upper_bound(first, first + group.childCount, position,
+                [this](double t, uint32_t c) { return t < starts[c]; });
+            segment = *(child - 1);
+            position = std::max(position - starts[segment], 0.0);
+            start += starts[segment];
+            index += segments[segment].offset;
+        }
+
+        const auto& run = segments[segment];
+        const double step = passAt(position, stepDuration(run), run.steps);
+        stepStart = start + step * stepDuration(run);
+        return index + static_cast<uint64_t>(step);
+    }
+
+private:
+    const ofxPresetsSequence* sequence = nullptr;
+    std::vector<double> durations; // of one pass of each segment
+    std::vector<double> starts;    // of each segment, from the start of a pass of its group
+    double loopDuration = 0.0;
+    float defaultHold = 0.0f;
+    float defaultTransition = 0.0f;
+
+    float holdOf(const ofxPresetsSequenceSegment& run) const {
+        return run.hold < 0.0f ? defaultHold : run.hold;
+    }
+
+    float transitionOf(const ofxPresetsSequenceSegment& run) const {
+        return run.transition < 0.0f ? defaultTransition : run.transition;
+    }
+
+    double stepDuration(const ofxPresetsSequenceSegment& run) const {
+        return static_cast<double>(transitionOf(run)) + holdOf(run);
+    }
+
+    // which of count passes of a duration is playing at a position, the last one when they take no time
+    static double passAt(double position, double duration, uint64_t count) {
+        if (duration <= 0.0) {
+            return static_cast<double>(count - 1);
+        }
+        return std::min(std::floor(position / duration), static_cast<double>(count - 1));
+    }
+};
@@ -0,0 +1,237 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "ofxPresetsBinary.h"
+
+/// <summary>
+/// Baked sequence track: the values of every parameter at each frame of a fixed frame rate
+///
+/// A fixed header, the slots of each value type (uint32, in the order of ofxPresetsTargetSet), then one row per frame.
+/// A row packs the values of all slots as the binary presets do: bools as uint8, ints as int32, floats as float32,
+/// doubles as float64, colors as four uint8 channels and the multi-component types as float32 channels.
+/// Rows are read in place from a memory mapping, playing a frame is a copy of its row into the lanes.
+/// Data is little-endian, the schema hash rejects tracks baked with other parameters
+/// </summary>
+class ofxPresetsTrack {
+public:
+
+    static constexpr uint32_t version = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t schemaHash;
+        double fps;
+        uint64_t frames;
+        uint32_t rowSize;
+        uint32_t bools;
+        uint32_t ints;
+        uint32_t floats;
+        uint32_t doubles;
+        uint32_t colors;
+        uint32_t vec2s;
+        uint32_t vec3s;
+        uint32_t vec4s;
+        uint32_t floatColors;
+        uint32_t rectangles;
+        uint32_t quats;
+    };
+
+    /// <summary>
+    /// Bytes of one frame for the slots of layout
+    /// </summary>
+    static size_t rowSize(const ofxPresetsTargetSet& layout) {
+        return layout.bools.size() + layout.ints.size() * sizeof(int32_t) + layout.floats.size() * sizeof(float) +
+            layout.doubles.size() * sizeof(double) + layout.colors.size() * 4 +
+            (layout.vec2s.values.size() + layout.vec3s.values.size() + layout.vec4s.values.size() +
+                layout.floatColors.values.size() + layout.rectangles.values.size() + layout.quats.values.size()) * sizeof(float);
+    }
+
+    /// <summary>
+    /// Header and slots of a track, the rows follow
+    /// </summary>
+    /// <param name="layout">the slots of the track, its values are not used</param>
+    static void encodeHeader(uint64_t schemaHash, double fps, uint64_t frames, const ofxPresetsTargetSet& layout, std::vector<uint8_t>& buffer) {
+        Header header;
+        std::memcpy(header.magic, "OFXT", 4);
+        header.version = version;
+        header.schemaHash = schemaHash;
+        header.fps = fps;
+        header.frames = frames;
+        header.rowSize = static_cast<uint32_t>(rowSize(layout));
+        header.bools = static_cast<uint32_t>(layout.bools.size());
+        header.ints = static_cast<uint32_t>(layout.ints.size());
+        header.floats = static_cast<uint32_t>(layout.floats.size());
+        header.doubles = static_cast<uint32_t>(layout.doubles.size());
+        header.colors = static_cast<uint32_t>(layout.colors.size());
+        header.vec2s = static_cast<uint32_t>(layout.vec2s.size());
+        header.vec3s = static_cast<uint32_t>(layout.vec3s.size());
+        header.vec4s = static_cast<uint32_t>(layout.vec4s.size());
+        header.floatColors = static_cast<uint32_t>(layout.floatColors.size());
+        header.rectangles = static_cast<uint32_t>(layout.rectangles.size());
+        header.quats = static_cast<uint32_t>(layout.quats.size());
+
+        buffer.resize(sizeof(Header));
+        std::memcpy(buffer.data(), &header, sizeof(Header));
+        ofxPresetsTargetSet::forEachLane([&buffer](const auto& lane) {
+            const uint8_t* slots = reinterpret_cast<const uint8_t*>(lane.slots.data());
+            buffer.insert(buffer.end(), slots, slots + lane.slots.size() * sizeof(uint32_t));
+        }, layout);
+    }
+
+    /// <summary>
+    /// Pack the current values of the lanes, added from the track layout, into a row
+    /// </summary>
+    static void encodeRow(const ofxPresetsInterpolator& lanes, const ofxPresetsTargetSet::Lane<uint8_t>& bools, uint8_t* row) {
+        std::memcpy(row, bools.values.data(), bools.values.size());
+        row += bools.values.size();
+        row = pack<int32_t>(lanes.ints.value, row);
+        row = pack<float>(lanes.floats.value, row);
+        row = pack<double>(lanes.doubles.value, row);
+        row = pack<uint8_t>(lanes.colors.value, row);
+        row = pack<float>(lanes.vec2s.value, row);
+        row = pack<float>(lanes.vec3s.value, row);
+        row = pack<float>(lanes.vec4s.value, row);
+        row = pack<float>(lanes.floatColors.value, row);
+        row = pack<float>(lanes.rectangles.value, row);
+        pack<float>(lanes.quats.value, row);
+    }
+
+    /// <summary>
+    /// Map a track for playback
+    /// </summary>
+    /// <param name="slotLanes">lane of each slot of the binding table, the slots of the track are checked against it</param>
+    /// <param name="error">reason when it fails</param>
+    /// <returns>false if the file is not a track for this schema</returns>
+    bool open(const std::string& path, uint64_t schemaHash, const std::vector<uint8_t>& slotLanes, std::string& error) {
+        close();
+        if (!file.open(path)) {
+            error = "could not map the file";
+            return false;
+        }
+        if (file.size() < sizeof(Header)) {
+            error = "file too short";
+            close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, "OFXT", 4) != 0 || header.version != version) {
+            error = "not a track file of version " + std::to_string(version);
+            close();
+            return false;
+        }
+        if (header.schemaHash != schemaHash) {
+            error = "baked with different parameters";
+            close();
+            return false;
+        }
+
+        layoutSet.clear();
+        size_t offset = sizeof(Header);
+        const uint32_t counts[] = { header.bools, header.ints, header.floats, header.doubles, header.colors,
+            header.vec2s, header.vec3s, header.vec4s, header.floatColors, header.rectangles, header.quats };
+        size_t lane = 0;
+        bool valid = true;
+        ofxPresetsTargetSet::forEachLane([&](auto& target) {
+            const size_t count = counts[lane++];
+            if (!valid || offset + count * sizeof(uint32_t) > file.size()) {
+                valid = false;
+                return;
+            }
+            target.slots.resize(count);
+            std::memcpy(target.slots.data(), file.data() + offset, count * sizeof(uint32_t));
+            target.values.resize(count * target.channels);
+            offset += count * sizeof(uint32_t);
+        }, layoutSet);
+
+        if (!valid || header.rowSize == 0 || header.rowSize != rowSize(layoutSet) || !(header.fps > 0.0) || header.frames == 0 ||
+            header.frames > (file.size() - offset) / header.rowSize) { // divided, a damaged frame count could wrap the product
+            error = "truncated file";
+            close();
+            return false;
+        }
+        if (!layoutSet.matches(slotLanes)) {
+            error = "slots do not match the parameters";
+            close();
+            return false;
+        }
+        rows = file.data() + offset;
+        file.adviseSequential();
+        return true;
+    }
+
+    void close() {
+        file.close();
+        rows = nullptr;
+        header = {};
+        layoutSet.clear();
+    }
+
+    bool isOpen() const { return rows != nullptr; }
+    uint64_t frames() const { return header.frames; }
+    uint64_t schemaHash() const { return header.schemaHash; }
+    double fps() const { return header.fps; }
+
+    /// <summary>
+    /// Slots of the track, add them to the lanes the rows are decoded into
+    /// </summary>
+    const ofxPresetsTargetSet& layout() const { return layoutSet; }
+
+    /// <summary>
+    /// Unpack the row of a frame into the values of lanes added from layout()
+    /// </summary>
+    void decodeRow(uint64_t frame, ofxPresetsInterpolator& lanes, ofxPresetsTargetSet::Lane<uint8_t>& bools) const {
+        const uint8_t* row = rows + frame * header.rowSize;
+        bools.values.resize(header.bools);
+        std::memcpy(bools.values.data(), row, header.bools);
+        row += header.bools;
+        row = unpack<int32_t>(row, lanes.ints.value);
+        row = unpack<float>(row, lanes.floats.value);
+        row = unpack<double>(row, lanes.doubles.value);
+        row = unpack<uint8_t>(row, lanes.colors.value);
+        row = unpack<float>(row, lanes.vec2s.value);
+        row = unpack<float>(row, lanes.vec3s.value);
+        row = unpack<float>(row, lanes.vec4s.value);
+        row = unpack<float>(row, lanes.floatColors.value);
+        row = unpack<float>(row, lanes.rectangles.value);
+        unpack<float>(row, lanes.quats.value);
+    }
+
+private:
+    ofxPresetsMappedFile file;
+    Header header = {};
+    ofxPresetsTargetSet layoutSet;
+    const uint8_t* rows = nullptr;
+
+    template<typename Packed, typename T>
+    static uint8_t* pack(const std::vector<T>& values, uint8_t* row) {
+        if (std::is_same<Packed, T>::value) {
+            std::memcpy(row, values.data(), values.size() * sizeof(T));
+        }
+        else {
+            for (size_t i = 0; i < values.size(); ++i) {
+                Packed value = static_cast<Packed>(values[i]);
+                std::memcpy(row + i * sizeof(Packed), &value, sizeof(Packed));
+            }
+        }
+        return row + values.size() * sizeof(Packed);
+    }
+
+    template<typename Packed, typename T>
+    static const uint8_t* unpack(const uint8_t* row, std::vector<T>& values) {
+        if (std::is_same<Packed, T>::value) {
+            std::memcpy(values.data(), row, values.size() * sizeof(T));
+        }
+        else {
+            for (size_t i = 0; i < values.size(); ++i) {
+                Packed value;
+                std::memcpy(&value, row + i * sizeof(Packed), sizeof(Packed));
+                values[i] = static_cast<T>(value);
+            }
+        }
+        return row + values.size() * sizeof(Packed);
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include "ofColor.h"
+#include "ofRectangle.h"
+#include "ofVectorMath.h"
+
+/// <summary>
+/// Component layout of the multi-component parameter types.
+/// Values are stored as `channels` floats, in the order they are saved in the json arrays:
+/// glm::vec2 [x, y], glm::vec3 [x, y, z], glm::vec4 [x, y, z, w], ofFloatColor [r, g, b, a],
+/// ofRectangle [x, y, width, height] and glm::quat [w, x, y, z]
+/// </summary>
+template<typename T>
+struct ofxPresetsVectorType;
+
+template<>
+struct ofxPresetsVectorType<glm::vec2> {
+    static constexpr size_t channels = 2;
+    static void write(const glm::vec2& v, float* c) { c[0] = v.x; c[1] = v.y; }
+    static glm::vec2 read(const float* c) { return glm::vec2(c[0], c[1]); }
+};
+
+template<>
+struct ofxPresetsVectorType<glm::vec3> {
+    static constexpr size_t channels = 3;
+    static void write(const glm::vec3& v, float* c) { c[0] = v.x; c[1] = v.y; c[2] = v.z; }
+    static glm::vec3 read(const float* c) { return glm::vec3(c[0], c[1], c[2]); }
+};
+
+template<>
+struct ofxPresetsVectorType<glm::vec4> {
+    static constexpr size_t channels = 4;
+    static void write(const glm::vec4& v, float* c) { c[0] = v.x; c[1] = v.y; c[2] = v.z; c[3] = v.w; }
+    static glm::vec4 read(const float* c) { return glm::vec4(c[0], c[1], c[2], c[3]); }
+};
+
+template<>
+struct ofxPresetsVectorType<ofFloatColor> {
+    static constexpr size_t channels = 4;
+    static void write(const ofFloatColor& v, float* c) { c[0] = v.r; c[1] = v.g; c[2] = v.b; c[3] = v.a; }
+    static ofFloatColor read(const float* c) { return ofFloatColor(c[0], c[1], c[2], c[3]); }
+};
+
+template<>
+struct ofxPresetsVectorType<ofRectangle> {
+    static constexpr size_t channels = 4;
+    static void write(const ofRectangle& v, float* c) { c[0] = v.x; c[1] = v.y; c[2] = v.width; c[3] = v.height; }
+    static ofRectangle read(const float* c) { return ofRectangle(c[0], c[1], c[2], c[3]); }
+};
+
+template<>
+struct ofxPresetsVectorType<glm::quat> {
+    static constexpr size_t channels = 4;
+    static void write(const glm::quat& v, float* c) { c[0] = v.w; c[1] = v.x; c[2] = v.y; c[3] = v.z; }
+    static glm::quat read(const float* c) { return glm::quat(c[0], c[1], c[2], c[3]); }
+};
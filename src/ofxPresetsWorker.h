@@ -0,0 +1,99 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// <summary>
+/// A single background thread running queued jobs in order.
+/// The thread is started with the first job and joined on stop() or destruction
+/// </summary>
+class ofxPresetsWorker {
+public:
+    ofxPresetsWorker() = default;
+    ofxPresetsWorker(const ofxPresetsWorker&) = delete;
+    ofxPresetsWorker& operator=(const ofxPresetsWorker&) = delete;
+
+    ~ofxPresetsWorker() {
+        stop();
+    }
+
+    /// <summary>
+    /// Queue a job to run on the worker thread
+    /// </summary>
+    void post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+            if (!thread.joinable()) {
+                stopping = false;
+                thread = std::thread(&ofxPresetsWorker::run, this);
+            }
+        }
+        wakeUp.notify_one();
+    }
+
+    /// <summary>
+    /// Drop the jobs that did not start yet
+    /// </summary>
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.clear();
+    }
+
+    /// <summary>
+    /// Block until every queued job has finished
+    /// </summary>
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return jobs.empty() && !busy; });
+    }
+
+    /// <summary>
+    /// Drop the pending jobs, let the running one finish and join the thread
+    /// </summary>
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.clear();
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeUp.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                break;
+            }
+
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+
+            lock.unlock();
+            job();
+            lock.lock();
+
+            busy = false;
+            idle.notify_all();
+        }
+        busy = false;
+        idle.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> jobs;
+    std::thread thread;
+    bool busy = false;
+    bool stopping = false;
+};
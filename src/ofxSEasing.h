@@ -1,3 +1,25 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// SIMD paths for the batch kernels, define OFX_SEASING_NO_SIMD to force the scalar fallback
+#if !defined(OFX_SEASING_NO_SIMD)
+#if defined(__AVX__)
+#define OFX_SEASING_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_SEASING_SSE
+#endif
+#endif
+
+#if defined(OFX_SEASING_AVX)
+#include <immintrin.h>
+#elif defined(OFX_SEASING_SSE)
+#include <emmintrin.h>
+#endif
+
 /// <summary>
 /// Simple easing functions for interpolation
 /// 
@@ -98,4 +120,380 @@ public:
             return 1 + 16 * t * t * t * t * t;
         }
     }
-};
\ No newline at end of file
+
+
+#pragma region Batch
+
+    // Branch-free select, scalar version of the SIMD blends below
+    static float select(bool mask, float a, float b) {
+        return mask ? a : b;
+    }
+
+#if defined(OFX_SEASING_SSE)
+    /// <summary>
+    /// Four packed floats, with just the operators the easing formulas need
+    /// </summary>
+    struct Float4 {
+        static constexpr size_t width = 4;
+        __m128 v;
+        Float4(__m128 v) : v(v) {}
+        Float4(float s) : v(_mm_set1_ps(s)) {}
+        static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+        friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+        friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+        friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+        friend Float4 operator<(Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    };
+    static Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    }
+#endif
+
+#if defined(OFX_SEASING_AVX)
+    /// <summary>
+    /// Eight packed floats, with just the operators the easing formulas need
+    /// </summary>
+    struct Float8 {
+        static constexpr size_t width = 8;
+        __m256 v;
+        Float8(__m256 v) : v(v) {}
+        Float8(float s) : v(_mm256_set1_ps(s)) {}
+        static Float8 load(const float* p) { return _mm256_loadu_ps(p); }
+        void store(float* p) const { _mm256_storeu_ps(p, v); }
+        friend Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+        friend Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+        friend Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+        friend Float8 operator<(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    };
+    static Float8 select(Float8 mask, Float8 a, Float8 b) {
+        return _mm256_blendv_ps(b.v, a.v, mask.v);
+    }
+#endif
+
+    // Easing tags, for the batch kernels and for compile-time selection.
+    // apply() is written once for float and for the packed types, both branches are evaluated and blended
+
+    struct Linear {
+        template<typename V> static V apply(V t) { return t; }
+    };
+
+    struct InQuad {
+        template<typename V> static V apply(V t) { return t * t; }
+    };
+
+    struct OutQuad {
+        template<typename V> static V apply(V t) { return t * (V(2.0f) - t); }
+    };
+
+    struct InOutQuad {
+        template<typename V> static V apply(V t) {
+            return select(t < V(0.5f), V(2.0f) * t * t, V(-1.0f) + (V(4.0f) - V(2.0f) * t) * t);
+        }
+    };
+
+    struct InCubic {
+        template<typename V> static V apply(V t) { return t * t * t; }
+    };
+
+    struct OutCubic {
+        template<typename V> static V apply(V t) {
+            V u = t - V(1.0f);
+            return u * u * u + V(1.0f);
+        }
+    };
+
+    struct InOutCubic {
+        template<typename V> static V apply(V t) {
+            V w = V(2.0f) * t - V(2.0f);
+            return select(t < V(0.5f), V(4.0f) * t * t * t, (t - V(1.0f)) * w * w + V(1.0f));
+        }
+    };
+
+    struct InQuart {
+        template<typename V> static V apply(V t) { return t * t * t * t; }
+    };
+
+    struct OutQuart {
+        template<typename V> static V apply(V t) {
+            V u = t - V(1.0f);
+            return V(1.0f) - u * u * u * u;
+        }
+    };
+
+    struct InOutQuart {
+        template<typename V> static V apply(V t) {
+            V u = t - V(1.0f);
+            return select(t < V(0.5f), V(8.0f) * t * t * t * t, V(1.0f) - V(8.0f) * u * u * u * u);
+        }
+    };
+
+    struct InQuint {
+        template<typename V> static V apply(V t) { return t * t * t * t * t; }
+    };
+
+    struct OutQuint {
+        template<typename V> static V apply(V t) {
+            V u = t - V(1.0f);
+            return V(1.0f) + u * u * u * u * u;
+        }
+    };
+
+    struct InOutQuint {
+        template<typename V> static V apply(V t) {
+            V u = t - V(1.0f);
+            return select(t < V(0.5f), V(16.0f) * t * t * t * t * t, V(1.0f) + V(16.0f) * u * u * u * u * u);
+        }
+    };
+
+    /// <summary>
+    /// Apply an easing to n values, i.e. ofxSEeasing::ease<ofxSEeasing::InOutCubic>(t, out, n)
+    /// </summary>
+    /// <param name="t">n normalized times</param>
+    /// <param name="out">n eased values, can be the same array as t</param>
+    template<typename Easing>
+    static void ease(const float* t, float* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        for (; i + Float8::width <= n; i += Float8::width) {
+            Easing::apply(Float8::load(t + i)).store(out + i);
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        for (; i + Float4::width <= n; i += Float4::width) {
+            Easing::apply(Float4::load(t + i)).store(out + i);
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = Easing::apply(t[i]);
+        }
+    }
+
+    /// <summary>
+    /// out = start + (target - start) * amount, for n values
+    /// </summary>
+    static void lerp(const float* start, const float* target, float amount, float* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        const Float8 a8(amount);
+        for (; i + Float8::width <= n; i += Float8::width) {
+            Float8 s = Float8::load(start + i);
+            (s + (Float8::load(target + i) - s) * a8).store(out + i);
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        const Float4 a4(amount);
+        for (; i + Float4::width <= n; i += Float4::width) {
+            Float4 s = Float4::load(start + i);
+            (s + (Float4::load(target + i) - s) * a4).store(out + i);
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = start[i] + (target[i] - start[i]) * amount;
+        }
+    }
+
+    /// <summary>
+    /// out = start + (target - start) * amount, for n doubles
+    /// </summary>
+    static void lerp(const double* start, const double* target, double amount, double* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        const __m256d a4 = _mm256_set1_pd(amount);
+        for (; i + 4 <= n; i += 4) {
+            __m256d s = _mm256_loadu_pd(start + i);
+            _mm256_storeu_pd(out + i, _mm256_add_pd(s, _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(target + i), s), a4)));
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        const __m128d a2 = _mm_set1_pd(amount);
+        for (; i + 2 <= n; i += 2) {
+            __m128d s = _mm_loadu_pd(start + i);
+            _mm_storeu_pd(out + i, _mm_add_pd(s, _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(target + i), s), a2)));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = start[i] + (target[i] - start[i]) * amount;
+        }
+    }
+
+    /// <summary>
+    /// out = start + (target - start) * amount for n integers, rounded to the nearest.
+    /// Computed in double, exact up to 2^53
+    /// </summary>
+    static void lerp(const int64_t* start, const int64_t* target, double amount, int64_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = start[i] + std::llround(static_cast<double>(target[i] - start[i]) * amount);
+        }
+    }
+
+    /// <summary>
+    /// Weighted sum of k source arrays of n floats, stored one after the other `stride` values apart:
+    /// out[i] = sum of weights[j] * sources[j * stride + i]
+    /// </summary>
+    static void blend(const float* sources, size_t stride, const float* weights, size_t k, float* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        for (; i + Float8::width <= n; i += Float8::width) {
+            Float8 sum = Float8::load(sources + i) * Float8(weights[0]);
+            for (size_t j = 1; j < k; ++j) {
+                sum = sum + Float8::load(sources + j * stride + i) * Float8(weights[j]);
+            }
+            sum.store(out + i);
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        for (; i + Float4::width <= n; i += Float4::width) {
+            Float4 sum = Float4::load(sources + i) * Float4(weights[0]);
+            for (size_t j = 1; j < k; ++j) {
+                sum = sum + Float4::load(sources + j * stride + i) * Float4(weights[j]);
+            }
+            sum.store(out + i);
+        }
+#endif
+        for (; i < n; ++i) {
+            float sum = sources[i] * weights[0];
+            for (size_t j = 1; j < k; ++j) {
+                sum += sources[j * stride + i] * weights[j];
+            }
+            out[i] = sum;
+        }
+    }
+
+    /// <summary>
+    /// Weighted sum of k source arrays of n doubles
+    /// </summary>
+    static void blend(const double* sources, size_t stride, const float* weights, size_t k, double* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        for (; i + 4 <= n; i += 4) {
+            __m256d sum = _mm256_mul_pd(_mm256_loadu_pd(sources + i), _mm256_set1_pd(weights[0]));
+            for (size_t j = 1; j < k; ++j) {
+                sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(sources + j * stride + i), _mm256_set1_pd(weights[j])));
+            }
+            _mm256_storeu_pd(out + i, sum);
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        for (; i + 2 <= n; i += 2) {
+            __m128d sum = _mm_mul_pd(_mm_loadu_pd(sources + i), _mm_set1_pd(weights[0]));
+            for (size_t j = 1; j < k; ++j) {
+                sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(sources + j * stride + i), _mm_set1_pd(weights[j])));
+            }
+            _mm_storeu_pd(out + i, sum);
+        }
+#endif
+        for (; i < n; ++i) {
+            double sum = sources[i] * static_cast<double>(weights[0]);
+            for (size_t j = 1; j < k; ++j) {
+                sum += sources[j * stride + i] * static_cast<double>(weights[j]);
+            }
+            out[i] = sum;
+        }
+    }
+
+    /// <summary>
+    /// Weighted sum of k source arrays of n integers, computed in double and rounded to the nearest
+    /// </summary>
+    static void blend(const int64_t* sources, size_t stride, const float* weights, size_t k, int64_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (size_t j = 0; j < k; ++j) {
+                sum += static_cast<double>(sources[j * stride + i]) * weights[j];
+            }
+            out[i] = std::llround(sum);
+        }
+    }
+
+    /// <summary>
+    /// Spherical interpolation of n unit quaternions, four interleaved components each.
+    /// Takes the shortest arc, and falls back to a normalized lerp for nearly equal rotations
+    /// </summary>
+    static void slerp(const float* start, const float* target, float amount, float* out, size_t n) {
+        if (amount <= 0.0f || amount >= 1.0f) {
+            // exact ends, the shortest arc would land on the negated target
+            std::copy(amount <= 0.0f ? start : target, (amount <= 0.0f ? start : target) + n * 4, out);
+            return;
+        }
+        for (size_t i = 0; i < n * 4; i += 4) {
+            const float* a = start + i;
+            float b[4] = { target[i], target[i + 1], target[i + 2], target[i + 3] };
+            float cosTheta = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            if (cosTheta < 0.0f) {
+                cosTheta = -cosTheta;
+                for (size_t c = 0; c < 4; ++c) {
+                    b[c] = -b[c];
+                }
+            }
+
+            float wa = 1.0f - amount;
+            float wb = amount;
+            if (cosTheta < 0.9995f) {
+                float theta = std::acos(cosTheta);
+                float sinTheta = std::sin(theta);
+                wa = std::sin(wa * theta) / sinTheta;
+                wb = std::sin(wb * theta) / sinTheta;
+            }
+
+            float q[4];
+            float length = 0.0f;
+            for (size_t c = 0; c < 4; ++c) {
+                q[c] = wa * a[c] + wb * b[c];
+                length += q[c] * q[c];
+            }
+            length = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+            for (size_t c = 0; c < 4; ++c) {
+                out[i + c] = q[c] * length;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Fused easing and lerp when all values share the same time:
+    /// the easing is evaluated once and inlined, the lerp is vectorized
+    /// </summary>
+    template<typename Easing>
+    static void lerp_eased(const float* start, const float* target, float t, float* out, size_t n) {
+        lerp(start, target, Easing::apply(std::clamp(t, 0.0f, 1.0f)), out, n);
+    }
+
+    /// <summary>
+    /// Fused easing and lerp with a time per value
+    /// </summary>
+    template<typename Easing>
+    static void lerp_eased(const float* start, const float* target, const float* t, float* out, size_t n) {
+        size_t i = 0;
+#if defined(OFX_SEASING_AVX)
+        for (; i + Float8::width <= n; i += Float8::width) {
+            Float8 s = Float8::load(start + i);
+            (s + (Float8::load(target + i) - s) * Easing::apply(Float8::load(t + i))).store(out + i);
+        }
+#endif
+#if defined(OFX_SEASING_SSE)
+        for (; i + Float4::width <= n; i += Float4::width) {
+            Float4 s = Float4::load(start + i);
+            (s + (Float4::load(target + i) - s) * Easing::apply(Float4::load(t + i))).store(out + i);
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = start[i] + (target[i] - start[i]) * Easing::apply(t[i]);
+        }
+    }
+
+    // Signature of lerp_eased<Easing> with a shared time, to pick an easing at runtime
+    // while keeping it inlined inside the loop
+    typedef void (*LerpKernel)(const float* start, const float* target, float t, float* out, size_t n);
+
+    /// <summary>
+    /// Scalar easing of a clamped time, i.e. ofxSEeasing::eased<ofxSEeasing::InOutCubic>(t)
+    /// </summary>
+    template<typename Easing>
+    static float eased(float t) {
+        return Easing::apply(std::clamp(t, 0.0f, 1.0f));
+    }
+
+    // Signature of eased<Easing>, to pick an easing at runtime and share it between value types
+    typedef float (*EasingCurve)(float t);
+
+#pragma endregion
+};